@@ -30,9 +30,33 @@ auto lexer = create_lexer<Tokens>(PatternSet{
     AnyOf(" \t\n"),
 });
 
+enum class Syntax {
+   Number,
+   Group,
+   Expression,
+};
+
+struct Expression;
+
+using Number = parser::ParseRule<Syntax::Number, parser::Is<Tokens::Number>>;
+using Group = parser::ParseRule<Syntax::Group,
+                                parser::Sequence<parser::Is<Tokens::OpenParen>, Expression, parser::Is<Tokens::CloseParen>>>;
+using Operand = parser::AnyOf<Number, Group>;
+using Operator = parser::AnyOf<parser::Is<Tokens::Plus>, parser::Is<Tokens::Minus>, parser::Is<Tokens::Multiply>,
+                               parser::Is<Tokens::Divide>>;
+
+// An operand directly followed by a group multiplies them
+struct Expression
+    : parser::ParseRule<Syntax::Expression,
+                        parser::Sequence<Operand, parser::Repeats<parser::Sequence<parser::Optional<Operator>, Operand>>>> {};
+
 } // namespace
 
 int main(int argc, char** argv) {
    auto res = lexer.lexUtf8("4 + 2(3 -1)/4");
-   return res.has_value() ? 0 : 1;
+   if (!res.has_value()) {
+      return 1;
+   }
+   auto tree = parser::parse<Expression>(res->tokens());
+   return tree.has_value() ? 0 : 1;
 }
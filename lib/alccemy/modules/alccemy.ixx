@@ -1,3 +1,4 @@
 export module alccemy;
 
 export import alccemy.lexer;
+export import alccemy.parser;
@@ -1,6 +1,10 @@
 module;
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 export module alccemy.lexer.concepts;
 
@@ -32,4 +36,57 @@ concept LexerPattern = requires(T& t, UnicodeCodePoint cp, size_t index) {
    t.terminate(index);
 };
 
+/**
+ * Mixes value into a hash, for combining the parts of a memo state
+ **/
+constexpr size_t memo_state_combine(size_t seed, size_t value) {
+   std::uint64_t mixed = seed ^ (value + 0x9e3779b97f4a7c15ull + (std::uint64_t(seed) << 6) + (seed >> 2));
+   mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ull;
+   mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebull;
+   return static_cast<size_t>(mixed ^ (mixed >> 31));
+}
+
+/**
+ * The exact state of a pattern as a sequence of words, with a hash of them kept
+ * alongside for lookups. Two states are only the same if all their words are
+ **/
+class MemoState {
+ public:
+   void clear() {
+      m_words.clear();
+      m_hash = 0;
+   }
+
+   void push(size_t word) {
+      m_words.push_back(word);
+      m_hash = memo_state_combine(m_hash, word);
+   }
+
+   std::span<const size_t> words() const { return m_words; }
+
+   size_t hash() const { return m_hash; }
+
+ private:
+   std::vector<size_t> m_words;
+   size_t m_hash = 0;
+};
+
+/**
+ * A lexer pattern that can describe its current state
+ *
+ * memo_state(index, state) pushes the words describing the pattern at the given
+ * index. Two pattern instances of the same type must only push the same words if
+ * feeding them the same codepoints, starting with the given index, yields the
+ * same results, and composite patterns push their own words ahead of those of
+ * their parts so that the encoding stays unambiguous. Index 0 always describes
+ * the freshly reset pattern.
+ *
+ * The lexer uses this to remember how a pattern fared past the end of a token,
+ * so that no (pattern, state, position) combination is ever scanned twice
+ **/
+template <typename T>
+concept MemoizablePattern = LexerPattern<T> && requires(const T& t, size_t index, MemoState& state) {
+   t.memo_state(index, state);
+};
+
 } // namespace alccemy
@@ -1,9 +1,14 @@
 module;
 
+#include <algorithm>
 #include <cassert>
 #include <expected>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -13,7 +18,9 @@ export module alccemy.lexer;
 
 export import alccemy.lexer.concepts;
 export import alccemy.lexer.errors;
+export import alccemy.lexer.line_index;
 export import alccemy.lexer.patterns;
+export import alccemy.lexer.string_pool;
 export import alccemy.lexer.text;
 export import alccemy.lexer.token;
 export import alccemy.lexer.tokenized_text;
@@ -39,6 +46,12 @@ export template <LexerPattern PatternT, TokenSet TokenSetT> class Tokenize {
 
    LexerResult terminate(size_t index) { return m_pattern.terminate(index); }
 
+   void memo_state(size_t index, MemoState& state) const
+      requires MemoizablePattern<PatternT>
+   {
+      m_pattern.memo_state(index, state);
+   }
+
    Token<TokenSetT> make_token(TextPos token_start, TextPos token_end) const {
       return Token<TokenSetT>(m_token_type, token_start, (token_end.text_index - token_start.text_index));
    }
@@ -51,6 +64,39 @@ export template <LexerPattern PatternT, TokenSet TokenSetT> class Tokenize {
 export template <LexerPattern PatternT, TokenSet TokenSetT>
 Tokenize(const PatternT& pattern, TokenSetT type) -> Tokenize<PatternT, TokenSetT>;
 
+//!
+//! Interns the spelling of each token the pattern produces, the token then
+//! carries the SymbolId of its spelling in the TokenizedText's string pool
+//!
+export template <LexerPattern PatternT> class Intern {
+ public:
+   static constexpr bool interns_spelling = true;
+
+   Intern(const PatternT& pattern) : m_pattern(pattern) {}
+
+   LexerResult check(UnicodeCodePoint cp, size_t index) { return m_pattern.check(cp, index); }
+
+   LexerResult terminate(size_t index) { return m_pattern.terminate(index); }
+
+   void memo_state(size_t index, MemoState& state) const
+      requires MemoizablePattern<PatternT>
+   {
+      m_pattern.memo_state(index, state);
+   }
+
+   auto make_token(TextPos token_start, TextPos token_end) const
+      requires requires(const PatternT& pattern) { pattern.make_token(token_start, token_end); }
+   {
+      return m_pattern.make_token(token_start, token_end);
+   }
+
+ private:
+   PatternT m_pattern;
+};
+
+template <typename T>
+concept InterningPattern = T::interns_spelling;
+
 export template <typename... RuleTs> using RuleSet = std::tuple<RuleTs...>;
 
 export template <LexerPattern... PatternTs> using PatternSet = std::tuple<PatternTs...>;
@@ -63,6 +109,14 @@ template <typename BasicErrorType, typename... RuleTypesT> struct ErrorTypes<Bas
    using type = JoinedVariant<BasicErrorType, decltype(RuleTypesT::ErrorType::error_type)...>;
 };
 
+//!
+//! Splits text into tokens, always picking the longest match among the patterns
+//!
+//! Lexing takes time linear in the length of the text as long as all patterns
+//! are MemoizablePattern, as all the built-in ones are: a pattern that scans
+//! ahead and fails is remembered per codepoint and state, so later token
+//! attempts never rescan the same stretch in the same way
+//!
 export template <TokenSet TokenSetT, typename RuleTs = RuleSet<>, typename PatternTs = PatternSet<>> class Lexer {
  public:
    using ErrorType = LexerFailure<TokenSetT, typename ErrorTypes<std::variant<UnexpectedCodepointError>, RuleTs>::type>;
@@ -98,10 +152,142 @@ export template <TokenSet TokenSetT, typename RuleTs = RuleSet<>, typename Patte
 
  private:
    struct CodepointInText {
-      CodepointInText(UnicodeCodePoint codepoint, const TextPos& pos) : codepoint(codepoint), pos(pos) {}
+      CodepointInText(UnicodeCodePoint codepoint, size_t offset) : codepoint(codepoint), offset(offset) {}
 
       UnicodeCodePoint codepoint;
-      TextPos pos;
+      size_t offset;
+   };
+
+   //!
+   //! Remembers how each pattern fared past the end of a token, the only
+   //! codepoints that are ever scanned by more than one token attempt. Keyed by
+   //! (pattern, codepoint ordinal, pattern memo state), so a pattern reaching a
+   //! known combination immediately knows where it will end up
+   //!
+   //! Entries are found through the hash of the state, but only match if all of
+   //! its words do, so states that share a hash never mix up their outcomes
+   //!
+   class LookaheadMemo {
+    public:
+      //! Byte offset where the pattern completes, or nothing if it fails
+      using Outcome = std::optional<size_t>;
+
+      const Outcome* find(size_t pattern_index, size_t ordinal, const MemoState& state) const {
+         if (ordinal >= m_horizon) {
+            return nullptr;
+         }
+         auto [first, last] = m_outcomes.equal_range(Key{pattern_index, ordinal, state.hash()});
+         for (auto ite = first; ite != last; ++ite) {
+            if (std::ranges::equal(words_of(m_words, ite->second.words), state.words())) {
+               return &ite->second.outcome;
+            }
+         }
+         return nullptr;
+      }
+
+      size_t pending_visits() const { return m_pending.size(); }
+
+      void visit(size_t pattern_index, size_t ordinal, const MemoState& state) {
+         m_pending.push_back(PendingVisit{Key{pattern_index, ordinal, state.hash()},
+                                          store_words(m_pending_words, state.words()), std::nullopt});
+      }
+
+      //! Sets the outcome of all visits since first_visit, a scan ends the same
+      //! way from any of the states it passed through
+      void resolve(size_t first_visit, const Outcome& outcome) {
+         for (size_t i = first_visit; i < m_pending.size(); ++i) {
+            m_pending[i].outcome = outcome;
+         }
+      }
+
+      //! Keeps the visits that the next token attempts can run into again
+      void commit(size_t next_token_ordinal) {
+         for (const auto& visit : m_pending) {
+            if (visit.key.ordinal >= next_token_ordinal) {
+               record(visit.key, words_of(m_pending_words, visit.words), visit.outcome);
+               m_horizon = std::max(m_horizon, visit.key.ordinal + 1);
+            }
+         }
+         m_pending.clear();
+         m_pending_words.clear();
+
+         if (m_outcomes.size() > m_prune_threshold) {
+            std::erase_if(m_outcomes, [&](const auto& entry) { return entry.first.ordinal < next_token_ordinal; });
+            compact_words();
+            m_prune_threshold = std::max(MIN_PRUNE_THRESHOLD, m_outcomes.size() * 2);
+         }
+      }
+
+    private:
+      static constexpr size_t MIN_PRUNE_THRESHOLD = 64;
+
+      struct Key {
+         size_t pattern_index;
+         size_t ordinal;
+         size_t state_hash;
+
+         bool operator==(const Key& other) const = default;
+      };
+
+      struct KeyHash {
+         size_t operator()(const Key& key) const {
+            return memo_state_combine(memo_state_combine(key.pattern_index, key.ordinal), key.state_hash);
+         }
+      };
+
+      //! Where the words of a state are kept in a word buffer
+      struct WordsRef {
+         size_t offset;
+         size_t size;
+      };
+
+      struct Entry {
+         WordsRef words;
+         Outcome outcome;
+      };
+
+      struct PendingVisit {
+         Key key;
+         WordsRef words;
+         Outcome outcome;
+      };
+
+      static std::span<const size_t> words_of(const std::vector<size_t>& buffer, WordsRef ref) {
+         return std::span<const size_t>(buffer).subspan(ref.offset, ref.size);
+      }
+
+      static WordsRef store_words(std::vector<size_t>& buffer, std::span<const size_t> words) {
+         WordsRef ref{buffer.size(), words.size()};
+         buffer.insert(buffer.end(), words.begin(), words.end());
+         return ref;
+      }
+
+      void record(const Key& key, std::span<const size_t> words, const Outcome& outcome) {
+         auto [first, last] = m_outcomes.equal_range(key);
+         for (auto ite = first; ite != last; ++ite) {
+            if (std::ranges::equal(words_of(m_words, ite->second.words), words)) {
+               ite->second.outcome = outcome;
+               return;
+            }
+         }
+         m_outcomes.emplace(key, Entry{store_words(m_words, words), outcome});
+      }
+
+      //! Drops the words of pruned entries
+      void compact_words() {
+         std::vector<size_t> words;
+         for (auto& [key, entry] : m_outcomes) {
+            entry.words = store_words(words, words_of(m_words, entry.words));
+         }
+         m_words = std::move(words);
+      }
+
+      std::unordered_multimap<Key, Entry, KeyHash> m_outcomes;
+      std::vector<size_t> m_words;
+      std::vector<PendingVisit> m_pending;
+      std::vector<size_t> m_pending_words;
+      size_t m_horizon = 0;
+      size_t m_prune_threshold = MIN_PRUNE_THRESHOLD;
    };
 
    template <UnicodeCodePoint (*step_f)(const std::string&, size_t&), void (*step_back_f)(const std::string&, size_t&)>
@@ -111,220 +297,215 @@ export template <TokenSet TokenSetT, typename RuleTs = RuleSet<>, typename Patte
                                                              const std::string& src_text) const {
          PatternTs patterns = base_patterns;
 
+         // Only byte offsets are tracked while lexing, lines and columns are
+         // resolved through the index for the positions that end up in tokens
+         LineIndex line_index(src_text);
+         LineCursor cursor(line_index, src_text);
+
          TokenizationState state;
 
          auto rules_states = create_rule_states(rules);
 
-         std::vector<CodepointInText> current_token_components;
+         // Codepoints pulled from the text that are not part of a token yet, the
+         // current token starts at window_start. Consumed codepoints are skipped
+         // rather than erased, and dropped in bulk once they make up most of it
+         std::vector<CodepointInText> components;
+         size_t window_start = 0;
+         size_t dropped_components = 0;
+
+         LookaheadMemo memo;
+         // Reused for every step so describing a state does not allocate
+         MemoState pattern_state;
+         std::optional<ErrorType> rule_error;
 
          auto pull_next = [&]() -> bool {
-            if (state.text_position.text_index >= src_text.size()) {
+            if (rule_error || state.text_offset >= src_text.size()) {
                return false;
             }
 
-            auto [next_pos, codepoint] = next(state.text_position, src_text);
+            size_t next_offset = state.text_offset;
+            auto codepoint = step_f(src_text, next_offset);
+            auto position = TextOffset(state.text_offset, cursor);
 
             // Apply rules for each new character
             auto rules_results =
                 tuple_for(rules, [&, this]<size_t... rule_indicies>(std::index_sequence<rule_indicies...>) {
                    ExpectedRulesResultT cur_result = RulesResult::Continue;
-                   (
-                       [&, this ]<size_t index = rule_indicies>() {
-                          if (cur_result && cur_result.value() == RulesResult::Consume) {
-                             return;
-                          }
-
-                          ExpectedRulesResultT res = std::get<index>(rules).handle_code_point(
-                              std::get<index>(rules_states), state.tokens, codepoint, state.text_position);
-                          if (!res || res.value() != RulesResult::Continue) {
-                             cur_result = res;
-                          }
-                       }(),
-                       ...);
+                   auto apply_rule = [&, this]<size_t index>() {
+                      if (!cur_result || cur_result.value() == RulesResult::Consume) {
+                         return;
+                      }
+
+                      ExpectedRulesResultT res = std::get<index>(rules).handle_code_point(
+                          std::get<index>(rules_states), state.tokens, codepoint, position);
+                      if (!res || res.value() != RulesResult::Continue) {
+                         cur_result = res;
+                      }
+                   };
+                   (apply_rule.template operator()<rule_indicies>(), ...);
                    return cur_result;
                 });
 
-            if (rules_results != RulesResult::Consume) {
-               current_token_components.push_back(CodepointInText(codepoint, state.text_position));
+            if (!rules_results) {
+               rule_error = rules_results.error();
+               return false;
+            }
+
+            if (rules_results.value() != RulesResult::Consume) {
+               components.push_back(CodepointInText(codepoint, state.text_offset));
             }
-            state.text_position = next_pos;
+            state.text_offset = next_offset;
 
             return true;
          };
 
-         auto apply_lexer_result = [&](auto& pattern, LexerResult res, size_t& current_codepoint_index) -> bool {
-            if (res.type == LexerResults::Completed) {
-               // Note, we backtrack from next position because we want the
-               // position right after the backtrack
-               auto end_index = current_codepoint_index + 1 - (res.backtrack_cols);
-               auto end_pos = state.text_position;
-               if (end_index < current_token_components.size()) {
-                  end_pos = current_token_components[end_index].pos;
-               }
-
-               auto token = state.make_token(pattern, end_pos, state.current_token_start);
-               if (state.best && state.best->token != std::nullopt) {
-                  // We only take the largest token, or the one that occurs first
-                  // if there multiple possible, so we get a well-defined
-                  // consistent behavior
-                  if (token && token->size() > state.best->token->size()) {
-                     state.best = CompletePattern(end_pos, token);
-                  }
-               } else {
-                  state.best = CompletePattern(end_pos, token);
-               }
-               return true;
-            } else if (res.type == LexerResults::Failed) {
-               return true;
-            } else {
-               current_codepoint_index += 1 - res.backtrack_cols;
-               return false;
+         auto end_offset = [&](size_t end_index) {
+            if (window_start + end_index < components.size()) {
+               return components[window_start + end_index].offset;
             }
+            return state.text_offset;
          };
 
-         while (state.text_position.text_index < src_text.size()) {
-            tuple_for_each(patterns, [&, this](auto& pattern, size_t patter_index) {
-               bool done = false;
-
-               size_t current_codepoint = 0;
-               while (!done) {
-                  while (!done && current_codepoint < current_token_components.size()) {
-                     auto codepoint = current_token_components[current_codepoint].codepoint;
-                     auto res = pattern.check(codepoint, current_codepoint);
-                     done = apply_lexer_result(pattern, res, current_codepoint);
-                  }
-                  if (!done && !pull_next()) {
-                     auto res = pattern.terminate(current_codepoint);
-                     apply_lexer_result(pattern, res, current_codepoint);
-                     return;
-                  }
-               }
-            });
-            if (state.best) {
-               auto& token = state.best->token;
-               if (token != std::nullopt) {
-                  state.tokens.push_back(*token);
+         auto complete = [&](auto& pattern, size_t end_pos) {
+            auto token = state.make_token(pattern, cursor, state.current_token_start, end_pos);
+            constexpr bool intern = InterningPattern<std::remove_cvref_t<decltype(pattern)>>;
+            if (state.best && state.best->token != std::nullopt) {
+               // We only take the largest token, or the one that occurs first
+               // if there multiple possible, so we get a well-defined
+               // consistent behavior
+               if (token && token->size() > state.best->token->size()) {
+                  state.best = CompletePattern(end_pos, token, intern);
                }
-               current_token_components.erase(
-                   std::remove_if(current_token_components.begin(), current_token_components.end(),
-                                  [&](const auto& comp) { return comp.pos < state.best->end_pos; }),
-                   current_token_components.end());
-               if (current_token_components.size() > 0) {
-                  state.current_token_start = current_token_components.front().pos;
-               } else {
-                  state.current_token_start = state.text_position;
-               }
-
-               state.reset_for_next_token();
             } else {
-               return std::unexpected(ErrorType(UnexpectedCodepointError(), state.tokens, state.current_token_start,
-                                                state.text_position.text_index));
+               state.best = CompletePattern(end_pos, token, intern);
             }
-         }
+         };
 
-         // TODO Terminate rules
+         while (true) {
+            // Codepoints consumed by rules are never part of a token
+            while (window_start == components.size() && pull_next()) {
+            }
+            if (rule_error) {
+               return std::unexpected(*rule_error);
+            }
+            if (window_start == components.size()) {
+               break;
+            }
+            state.current_token_start = components[window_start].offset;
 
-         /*
-         while (state.text_position.text_index < src_text.size()) {
-            auto [next_pos, codepoint] = next(state.text_position, src_text);
+            tuple_for_each(patterns, [&, this](auto& pattern, size_t pattern_index) {
+               size_t first_visit = memo.pending_visits();
+               typename LookaheadMemo::Outcome outcome = std::nullopt;
 
-            auto rules_results =
-                tuple_for(rules, [&, this]<size_t... rule_indicies>(std::index_sequence<rule_indicies...>) {
-                   ExpectedRulesResultT cur_result = RulesResult::Continue;
-                   (
-                       [&, this ]<size_t index = rule_indicies>() {
-                          if (cur_result && cur_result.value() == RulesResult::Consume) {
-                             return;
-                          }
-
-                          ExpectedRulesResultT res = std::get<index>(rules).handle_code_point(
-                              std::get<index>(rules_states), state.tokens, codepoint, state.text_position);
-                          if (!res || res.value() != RulesResult::Continue) {
-                             cur_result = res;
-                          }
-                       }(),
-                       ...);
-                   return cur_result;
-                });
+               size_t current_codepoint = 0;
+               while (true) {
+                  bool at_end = window_start + current_codepoint >= components.size();
+                  if (at_end && pull_next()) {
+                     continue;
+                  }
 
-            if (!rules_results) {
-               return std::unexpected(rules_results.error());
-            }
+                  if constexpr (MemoizablePattern<std::remove_cvref_t<decltype(pattern)>>) {
+                     size_t ordinal = dropped_components + window_start + current_codepoint;
+                     pattern_state.clear();
+                     pattern.memo_state(current_codepoint, pattern_state);
+                     if (auto known = memo.find(pattern_index, ordinal, pattern_state)) {
+                        outcome = *known;
+                        break;
+                     }
+                     memo.visit(pattern_index, ordinal, pattern_state);
+                  }
 
-            if (rules_results != RulesResult::Consume) {
-               tuple_for_each(patterns, [&](auto& pattern, size_t patter_index) {
-                  if (!state.done[patter_index]) {
-                     state.apply_lexer_result(pattern.check(codepoint, state.consumed_cps_for_current_token), next_pos,
-                                              state.current_token_start, src_text, pattern, patter_index);
+                  auto res = at_end ? pattern.terminate(current_codepoint)
+                                    : pattern.check(components[window_start + current_codepoint].codepoint,
+                                                    current_codepoint);
+                  if (res.type == LexerResults::Completed) {
+                     // Note, we backtrack from next position because we want the
+                     // position right after the backtrack
+                     outcome = end_offset(current_codepoint + 1 - res.backtrack_cols);
+                     break;
                   }
-               });
-            }
+                  if (res.type == LexerResults::Failed || at_end) {
+                     break;
+                  }
+                  current_codepoint += 1 - res.backtrack_cols;
+               }
 
-            if (next_pos.text_index == src_text.size() || rules_results != RulesResult::Continue) {
-               // Ignore if we have consumed the first token
-               if (rules_results != RulesResult::Consume || state.consumed_cps_for_current_token > 0) {
-                  // Inform currently acttive patterns that they are all done
-                  // parsing, letting them fail or complete as relevant
-                  tuple_for_each(patterns, [&](auto& pattern, size_t patter_index) {
-                     if (!state.done[patter_index]) {
-                        state.apply_lexer_result(pattern.terminate(state.consumed_cps_for_current_token + 1), next_pos,
-                                                 state.current_token_start, src_text, pattern, patter_index);
-                     }
-                  });
+               memo.resolve(first_visit, outcome);
+               if (outcome) {
+                  complete(pattern, *outcome);
                }
-            }
+            });
 
-            if (rules_results != RulesResult::Consume) {
-               state.consumed_cps_for_current_token += 1;
+            if (rule_error) {
+               return std::unexpected(*rule_error);
+            }
+            // An empty match would never move on
+            if (!state.best || state.best->end_pos <= state.current_token_start) {
+               return std::unexpected(ErrorType(UnexpectedCodepointError(), state.tokens,
+                                                cursor.position(state.current_token_start), state.current_token_start));
             }
 
-            if (state.all_done()) {
-               if (state.best) {
-                  auto& token = state.best->token;
-                  if (token != std::nullopt) {
-                     state.tokens.push_back(*token);
-                  }
-                  next_pos = state.best->end_pos;
-                  state.consumed_cps_for_current_token = 0;
-
-                  state.reset_for_next_token();
-               } else {
-                  return std::unexpected(ErrorType(UnexpectedCodepointError(), state.tokens, state.current_token_start,
-                                                   state.text_position.text_index));
+            auto& token = state.best->token;
+            if (token != std::nullopt) {
+               if (state.best->intern) {
+                  auto spelling = std::string_view(src_text).substr(token->pos().text_index, token->size());
+                  state.symbol_ids.resize(state.tokens.size(), TokenizedText<TokenSetT>::NO_SYMBOL);
+                  state.symbol_ids.push_back(state.string_pool.intern(spelling));
                }
+               state.tokens.push_back(*token);
             }
-
-            if (next_pos.line > state.text_position.line) {
-               state.line_length_stack.push_back(state.text_position.col);
+            while (window_start < components.size() && components[window_start].offset < state.best->end_pos) {
+               ++window_start;
             }
-            state.text_position = next_pos;
+            memo.commit(dropped_components + window_start);
 
-            if (state.consumed_cps_for_current_token == 0) {
-               state.current_token_start = state.text_position;
+            if (window_start >= COMPACTION_THRESHOLD && window_start * 2 >= components.size()) {
+               components.erase(components.begin(), components.begin() + window_start);
+               dropped_components += window_start;
+               window_start = 0;
             }
+
+            state.reset_for_next_token();
          }
+
          // Finalize rules
+         TextPos end_position = cursor.position(state.text_offset);
+         std::optional<ErrorType> end_error;
          tuple_for(rules, [&, this]<size_t... rule_indicies>(std::index_sequence<rule_indicies...>) {
-            (
-                [&, this ]<size_t index = rule_indicies>() {
-                   std::get<index>(rules).end_lexing(std::get<index>(rules_states), state.tokens, state.text_position);
-                }(),
-                ...);
+            auto end_rule = [&, this]<size_t index>() {
+               if (end_error) {
+                  return;
+               }
+               auto res =
+                   std::get<index>(rules).end_lexing(std::get<index>(rules_states), state.tokens, end_position);
+               if (!res) {
+                  end_error = ErrorType(res.error());
+               }
+            };
+            (end_rule.template operator()<rule_indicies>(), ...);
          });
-         */
+         if (end_error) {
+            return std::unexpected(*end_error);
+         }
+
          // Always append an end of file token here
-         state.tokens.push_back(Token<TokenSetT>(Token<TokenSetT>::Type::EndOfFile, state.text_position, 0));
+         state.tokens.push_back(Token<TokenSetT>(Token<TokenSetT>::Type::EndOfFile, end_position, 0));
 
-         return TokenizedText(state.tokens);
+         if (!state.symbol_ids.empty()) {
+            state.symbol_ids.resize(state.tokens.size(), TokenizedText<TokenSetT>::NO_SYMBOL);
+         }
+         return TokenizedText<TokenSetT>(std::move(state.tokens), std::move(state.string_pool),
+                                         std::move(state.symbol_ids), std::move(line_index));
       }
 
       class CompletePattern {
        public:
-         CompletePattern(TextPos end_pos, const std::optional<Token<TokenSetT>>& token)
-             : end_pos(end_pos), token(token) {}
+         CompletePattern(size_t end_pos, const std::optional<Token<TokenSetT>>& token, bool intern = false)
+             : end_pos(end_pos), token(token), intern(intern) {}
 
-         TextPos end_pos;
+         size_t end_pos;
          std::optional<Token<TokenSetT>> token;
+         bool intern;
       };
 
       template <typename... RuleTs> static auto create_rule_states(const std::tuple<RuleTs...>& rules) {
@@ -335,107 +516,35 @@ export template <TokenSet TokenSetT, typename RuleTs = RuleSet<>, typename Patte
 
       class TokenizationState {
        public:
-         TokenizationState() {
-            for (size_t i = 0; i < std::tuple_size_v<PatternTs>; ++i) {
-               done[i] = false;
-            }
-         }
-
-         bool all_done() const {
-            for (size_t i = 0; i < std::tuple_size_v<PatternTs>; ++i) {
-               if (!done[i]) {
-                  return false;
-               }
-            }
-            return true;
-         }
-
-         void reset_for_next_token() {
-            for (size_t i = 0; i < std::tuple_size_v<PatternTs>; ++i) {
-               done[i] = false;
-            }
-            best = std::nullopt;
-         }
-
-         template <LexerPattern PatternT>
-         void apply_lexer_result(const LexerResult& res, const TextPos& next_position,
-                                 const TextPos& current_token_start, const std::string& source_text,
-                                 const PatternT& pattern, size_t pattern_index) {
-            if (res.type == LexerResults::Completed) {
-               // Note, we backtrack from next position because we want the
-               // position right after the backtrack
-               auto backtracked = backtrack(next_position, res.backtrack_cols, line_length_stack, source_text);
-               auto token = make_token(pattern, backtracked, current_token_start);
-               if (best && best->token != std::nullopt) {
-                  // We only take the largest token, or the one that occurs first
-                  // if there multiple possible, so we get a well-defined
-                  // consistent behavior
-                  if (token && token->size() > best->token->size()) {
-                     best = CompletePattern(backtracked, token);
-                  }
-               } else {
-                  best = CompletePattern(backtracked, token);
-               }
-               done[pattern_index] = true;
-            } else if (res.type == LexerResults::Failed) {
-               done[pattern_index] = true;
-            } else if (res.type == LexerResults::Continue && res.backtrack_cols > 0) {
-            }
-         }
+         void reset_for_next_token() { best = std::nullopt; }
 
        public:
-         std::vector<size_t> line_length_stack;
-         bool done[std::tuple_size_v<PatternTs>];
          std::optional<CompletePattern> best;
 
          Tokens<TokenSetT> tokens;
-         TextPos text_position = TextPos(0, 0, 0);
-         TextPos current_token_start = TextPos(0, 0, 0);
-         size_t consumed_cps_for_current_token = 0;
+         StringPool string_pool;
+         std::vector<SymbolId> symbol_ids;
+         // Byte offsets into the text
+         size_t text_offset = 0;
+         size_t current_token_start = 0;
 
        public:
-         TextPos backtrack(const TextPos& pos, size_t count, const std::vector<size_t>& line_length_stack,
-                           const std::string& source_text) {
-            assert(count <= pos.text_index);
-
-            TextPos new_pos = pos;
-            // Note immediate skip backwards, this position will be inconsistent
-            // until function return
-            for (size_t i = 0; i < count; ++i) {
-               step_back_f(source_text, new_pos.text_index);
-            }
-
-            while (count > new_pos.col) {
-               count -= new_pos.col;
-               new_pos.line -= 1;
-               new_pos.col = line_length_stack.at(new_pos.line);
-            }
-            new_pos.col -= count;
-            return new_pos;
-         }
-
          template <TokenPattern<TokenSetT> T>
-         std::optional<Token<TokenSetT>> make_token(const T& pattern, TextPos end_pos, TextPos token_start_pos) {
-            return pattern.make_token(token_start_pos, end_pos);
+         std::optional<Token<TokenSetT>> make_token(const T& pattern, LineCursor& cursor, size_t token_start,
+                                                    size_t token_end) {
+            auto start_pos = cursor.position(token_start);
+            return pattern.make_token(start_pos, cursor.position(token_end));
          }
 
          template <typename T>
-         std::optional<Token<TokenSetT>> make_token(const T& pattern, TextPos end_pos, TextPos token_start_pos) {
+         std::optional<Token<TokenSetT>> make_token(const T& pattern, LineCursor& cursor, size_t token_start,
+                                                    size_t token_end) {
             return std::nullopt;
          }
       };
 
-      static std::tuple<TextPos, UnicodeCodePoint> next(const TextPos& pos, const std::string& text) {
-         TextPos new_pos = pos;
-         auto cp = step_f(text, new_pos.text_index);
-         if (text[pos.text_index] == '\n') {
-            new_pos.col = 0;
-            new_pos.line += 1;
-         } else {
-            new_pos.col += 1;
-         }
-         return std::make_tuple(new_pos, cp);
-      }
+      // Number of consumed codepoints worth compacting the pending codepoints for
+      static constexpr size_t COMPACTION_THRESHOLD = 256;
    };
 };
 
@@ -0,0 +1,120 @@
+module;
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+export module alccemy.lexer.line_index;
+
+import alccemy.lexer.text;
+
+export namespace alccemy {
+
+//!
+//! Start of every line in UTF-8 text, built in a single memchr scan for
+//! newlines. Maps byte offsets to lines by binary search, so lines and
+//! columns only have to be worked out for the offsets someone asks about
+//!
+class LineIndex {
+ public:
+   LineIndex() : m_line_starts{0} {}
+
+   explicit LineIndex(std::string_view text) : m_line_starts{0} {
+      const char* begin = text.data();
+      const char* end = begin + text.size();
+      const char* cur = begin;
+      while (cur < end) {
+         auto newline = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+         if (newline == nullptr) {
+            break;
+         }
+         cur = newline + 1;
+         m_line_starts.push_back(cur - begin);
+      }
+   }
+
+   size_t line_count() const { return m_line_starts.size(); }
+
+   size_t line_start(size_t line) const { return m_line_starts.at(line); }
+
+   //! The line the byte offset is on
+   size_t line_of(size_t offset) const {
+      auto ite = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset);
+      return std::distance(m_line_starts.begin(), ite) - 1;
+   }
+
+   //! Resolves a byte offset, text must be the text the index was built from
+   TextPos position(std::string_view text, size_t offset) const {
+      size_t line = line_of(offset);
+      return TextPos(line, count_codepoints(text, m_line_starts[line], offset), offset);
+   }
+
+   //! Codepoints in the UTF-8 text between two byte offsets
+   static size_t count_codepoints(std::string_view text, size_t from, size_t to) {
+      return std::count_if(text.begin() + from, text.begin() + to,
+                           [](char c) { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; });
+   }
+
+ private:
+   std::vector<size_t> m_line_starts;
+};
+
+//!
+//! Resolves a stream of byte offsets to positions, each in time proportional
+//! to how far it is from the previous one on the same line. Meant for offsets
+//! that mostly move forward, like the tokens of a lexer
+//!
+class LineCursor {
+ public:
+   LineCursor(const LineIndex& index, std::string_view text) : m_index(&index), m_text(text) {}
+
+   TextPos position(size_t offset) {
+      if (offset < m_line_start || offset >= m_next_line_start) {
+         m_line = m_index->line_of(offset);
+         m_line_start = m_index->line_start(m_line);
+         m_next_line_start =
+             m_line + 1 < m_index->line_count() ? m_index->line_start(m_line + 1) : std::string_view::npos;
+         m_offset = m_line_start;
+         m_col = 0;
+      }
+
+      if (offset >= m_offset) {
+         m_col += LineIndex::count_codepoints(m_text, m_offset, offset);
+      } else {
+         m_col -= LineIndex::count_codepoints(m_text, offset, m_offset);
+      }
+      m_offset = offset;
+
+      return TextPos(m_line, m_col, m_offset);
+   }
+
+ private:
+   const LineIndex* m_index;
+   std::string_view m_text;
+
+   size_t m_line = 0;
+   size_t m_line_start = 0;
+   size_t m_next_line_start = 0;
+   size_t m_offset = 0;
+   size_t m_col = 0;
+};
+
+//!
+//! A byte offset into the text being lexed, the line and column are only
+//! resolved if asked for
+//!
+class TextOffset {
+ public:
+   TextOffset(size_t offset, LineCursor& cursor) : m_offset(offset), m_cursor(&cursor) {}
+
+   size_t text_index() const { return m_offset; }
+
+   TextPos position() const { return m_cursor->position(m_offset); }
+
+ private:
+   size_t m_offset;
+   LineCursor* m_cursor;
+};
+
+} // namespace alccemy
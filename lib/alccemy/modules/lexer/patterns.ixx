@@ -1,11 +1,16 @@
 module;
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <limits>
 #include <string>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
-#include <utf8cpp/utf8.h>>
+#include <utf8cpp/utf8.h>
 
 export module alccemy.lexer.patterns;
 
@@ -53,6 +58,8 @@ class Text {
 
    LexerResult terminate(size_t index) { return LexerResult(LexerResults::Failed, 0); }
 
+   void memo_state(size_t index, MemoState& state) const { state.push(index); }
+
  private:
    std::vector<UnicodeCodePoint> m_text;
 };
@@ -75,6 +82,8 @@ class AnyOf {
 
    LexerResult terminate(size_t index) { return LexerResult(LexerResults::Failed, 0); }
 
+   void memo_state(size_t index, MemoState& state) const {}
+
  private:
    std::unordered_set<UnicodeCodePoint> m_permitted;
 };
@@ -97,6 +106,8 @@ class NotAnyOf {
 
    LexerResult terminate(size_t index) { return LexerResult(LexerResults::Failed, 0); }
 
+   void memo_state(size_t index, MemoState& state) const {}
+
  private:
    std::unordered_set<UnicodeCodePoint> m_not_permitted;
 };
@@ -117,6 +128,9 @@ template <LexerPattern T, size_t min = 1, size_t max = (size_t)std::numeric_limi
          m_offset = index;
          m_offset += 1 - res.backtrack_cols;
 
+         if (m_repeats == max) {
+            return LexerResult(LexerResults::Completed, res.backtrack_cols);
+         }
          return LexerResult(LexerResults::Continue, res.backtrack_cols);
       }
       if (res.type == LexerResults::Failed) {
@@ -140,7 +154,19 @@ template <LexerPattern T, size_t min = 1, size_t max = (size_t)std::numeric_limi
          }
       }
       return LexerResult(LexerResults::Failed, 0);
-      ;
+   }
+
+   void memo_state(size_t index, MemoState& state) const
+      requires MemoizablePattern<T>
+   {
+      if (index == 0) {
+         state.push(0);
+         m_pattern.memo_state(0, state);
+         return;
+      }
+      // Without an upper bound, any count past min behaves the same
+      state.push(max == std::numeric_limits<size_t>::max() ? std::min(m_repeats, min) : m_repeats);
+      m_pattern.memo_state(index - m_offset, state);
    }
 
  private:
@@ -162,49 +188,66 @@ template <LexerPattern... PatternT> class Pattern {
          m_pattern_index = 0;
          m_offset = 0;
       }
-      auto res = process_pattern<0>(cp, index - m_offset);
+      auto res = process_pattern(cp, index - m_offset);
       if (res.type == LexerResults::Completed) {
          m_pattern_index += 1;
          if (m_pattern_index >= sizeof...(PatternT)) {
             return LexerResult(LexerResults::Completed, res.backtrack_cols);
          }
 
-         m_offset = index + 1;
+         m_offset = index + 1 - res.backtrack_cols;
 
          return LexerResult(LexerResults::Continue, res.backtrack_cols);
       }
       return res;
    }
 
-   LexerResult terminate(size_t index) { return terminate_pattern<0>(index - m_offset); }
-
- private:
-   template <std::size_t I = 0, typename... Tp>
-   inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type process_pattern(UnicodeCodePoint cp,
-                                                                                               size_t index) {
-      return LexerResult(LexerResults::Failed, 0);
+   LexerResult terminate(size_t index) {
+      if (index == 0) {
+         m_pattern_index = 0;
+         m_offset = 0;
+      }
+      auto res = terminate_pattern(index - m_offset);
+      // Trailing sub-patterns still get their say, they may accept nothing
+      while (res.type == LexerResults::Completed && m_pattern_index + 1 < sizeof...(PatternT)) {
+         m_pattern_index += 1;
+         res = terminate_pattern(0);
+      }
+      return res;
    }
 
-   template <std::size_t I = 0, typename... Tp>
-       inline typename std::enable_if <
-       I<sizeof...(PatternT), LexerResult>::type process_pattern(UnicodeCodePoint cp, size_t index) {
-      if (m_pattern_index == I) {
-         return std::get<I>(m_pattern).check(cp, index);
+   void memo_state(size_t index, MemoState& state) const
+      requires(MemoizablePattern<PatternT> && ...)
+   {
+      if (index == 0) {
+         state.push(0);
+         std::get<0>(m_pattern).memo_state(0, state);
+         return;
       }
-      return process_pattern<I + 1>(cp, index);
+      state.push(m_pattern_index);
+      size_t index_in_pattern = index - m_offset;
+      [&, this]<size_t... indicies>(std::index_sequence<indicies...>) {
+         ((m_pattern_index == indicies ? (std::get<indicies>(m_pattern).memo_state(index_in_pattern, state), true)
+                                       : false) ||
+          ...);
+      }(std::index_sequence_for<PatternT...>{});
    }
 
-   template <std::size_t I = 0, typename... Tp>
-   inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type terminate_pattern(size_t index) {
-      return LexerResult(LexerResults::Failed, 0);
+ private:
+   LexerResult process_pattern(UnicodeCodePoint cp, size_t index) {
+      return [&, this]<size_t... indicies>(std::index_sequence<indicies...>) {
+         LexerResult res(LexerResults::Failed, 0);
+         ((m_pattern_index == indicies ? (res = std::get<indicies>(m_pattern).check(cp, index), true) : false) || ...);
+         return res;
+      }(std::index_sequence_for<PatternT...>{});
    }
 
-   template <std::size_t I = 0, typename... Tp>
-       inline typename std::enable_if < I<sizeof...(PatternT), LexerResult>::type terminate_pattern(size_t index) {
-      if (m_pattern_index == I) {
-         return std::get<I>(m_pattern).terminate(index);
-      }
-      return terminate_pattern<I + 1>(index);
+   LexerResult terminate_pattern(size_t index) {
+      return [&, this]<size_t... indicies>(std::index_sequence<indicies...>) {
+         LexerResult res(LexerResults::Failed, 0);
+         ((m_pattern_index == indicies ? (res = std::get<indicies>(m_pattern).terminate(index), true) : false) || ...);
+         return res;
+      }(std::index_sequence_for<PatternT...>{});
    }
 
    std::tuple<PatternT...> m_pattern;
@@ -226,7 +269,7 @@ template <LexerPattern... PatternT> class Patterns {
             m_failed[i] = false;
          }
       }
-      auto res = process_pattern<0>(cp, index);
+      auto res = process_pattern(cp, index);
       if (res.type == LexerResults::Continue) {
          for (size_t i = 0; i < sizeof...(PatternT); ++i) {
             if (m_failed[i] == false) {
@@ -239,45 +282,57 @@ template <LexerPattern... PatternT> class Patterns {
       }
    }
 
-   LexerResult terminate(size_t index) { return terminate_pattern<0>(index); }
-
- private:
-   template <std::size_t I = 0, typename... Tp>
-   inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type process_pattern(UnicodeCodePoint cp,
-                                                                                               size_t index) {
-      return LexerResult(LexerResults::Continue, 0);
+   LexerResult terminate(size_t index) {
+      if (index == 0) {
+         for (size_t i = 0; i < sizeof...(PatternT); ++i) {
+            m_failed[i] = false;
+         }
+      }
+      return terminate_pattern(index);
    }
 
-   template <std::size_t I = 0, typename... Tp>
-       inline typename std::enable_if <
-       I<sizeof...(PatternT), LexerResult>::type process_pattern(UnicodeCodePoint cp, size_t index) {
-      if (!m_failed[I]) {
-         auto res = std::get<I>(m_pattern).check(cp, index);
-         if (res.type == LexerResults::Completed) {
-            return res;
-         } else if (res.type == LexerResults::Failed) {
-            m_failed[I] = true;
+   void memo_state(size_t index, MemoState& state) const
+      requires(MemoizablePattern<PatternT> && ...)
+   {
+      // A failed part pushes nothing past its flag
+      auto part_state = [&]<size_t part>() {
+         bool failed = index != 0 && m_failed[part];
+         state.push(failed);
+         if (!failed) {
+            std::get<part>(m_pattern).memo_state(index, state);
          }
-      }
-      return process_pattern<I + 1>(cp, index);
+      };
+      [&]<size_t... indicies>(std::index_sequence<indicies...>) {
+         (part_state.template operator()<indicies>(), ...);
+      }(std::index_sequence_for<PatternT...>{});
    }
 
-   template <std::size_t I = 0, typename... Tp>
-   inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type terminate_pattern(size_t index) {
-      return LexerResult(LexerResults::Failed, 0);
+ private:
+   // Patterns that have not failed yet are tried in order, the first to complete wins
+   LexerResult process_pattern(UnicodeCodePoint cp, size_t index) {
+      return [&, this]<size_t... indicies>(std::index_sequence<indicies...>) {
+         LexerResult res(LexerResults::Continue, 0);
+         ((!m_failed[indicies] && step_pattern<indicies>(std::get<indicies>(m_pattern).check(cp, index), res)) || ...);
+         return res;
+      }(std::index_sequence_for<PatternT...>{});
    }
 
-   template <std::size_t I = 0, typename... Tp>
-       inline typename std::enable_if < I<sizeof...(PatternT), LexerResult>::type terminate_pattern(size_t index) {
-      if (!m_failed[I]) {
-         auto res = std::get<I>(m_pattern).terminate(index);
-         if (res.type == LexerResults::Completed) {
-            return res;
-         } else if (res.type == LexerResults::Failed) {
-            m_failed[I] = true;
-         }
+   LexerResult terminate_pattern(size_t index) {
+      return [&, this]<size_t... indicies>(std::index_sequence<indicies...>) {
+         LexerResult res(LexerResults::Failed, 0);
+         ((!m_failed[indicies] && step_pattern<indicies>(std::get<indicies>(m_pattern).terminate(index), res)) || ...);
+         return res;
+      }(std::index_sequence_for<PatternT...>{});
+   }
+
+   template <size_t I> bool step_pattern(const LexerResult& res, LexerResult& completed) {
+      if (res.type == LexerResults::Completed) {
+         completed = res;
+         return true;
+      } else if (res.type == LexerResults::Failed) {
+         m_failed[I] = true;
       }
-      return terminate_pattern<I + 1>(index);
+      return false;
    }
 
    std::tuple<PatternT...> m_pattern;
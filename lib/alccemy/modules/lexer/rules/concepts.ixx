@@ -7,6 +7,7 @@ export module alccemy.lexer.rules.concepts;
 
 import alccemy.lexer.rules.types;
 import alccemy.lexer.errors;
+import alccemy.lexer.line_index;
 import alccemy.lexer.token;
 import alccemy.lexer.text;
 import alccemy.lexer.unicode;
@@ -18,12 +19,15 @@ concept ExpectedValue = std::same_as<ValueT, std::expected<ResultT, ErrorType>>;
 
 /**
  * Constraints that a lexer rule class needs to fulfill
+ *
+ * Rules see every codepoint, so they get its byte offset and only resolve the
+ * line and column when they need them
  **/
 template <typename T, typename TokenSetT>
-concept LexerRule = requires(T& t, Tokens<TokenSetT>& tokens, UnicodeCodePoint cp, TextPos pos) {
+concept LexerRule = requires(T& t, Tokens<TokenSetT>& tokens, UnicodeCodePoint cp, TextOffset offset, TextPos pos) {
    t.initial_state();
    {
-      t.handle_code_point(decltype(t.initial_state())(), tokens, cp, pos)
+      t.handle_code_point(decltype(t.initial_state())(), tokens, cp, offset)
    } -> ExpectedValue<RulesResult, TokenSetT, typename T::ErrorType>;
    {
       t.end_lexing(decltype(t.initial_state())(), tokens, pos)
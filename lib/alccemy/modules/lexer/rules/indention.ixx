@@ -10,6 +10,7 @@ export module alccemy.lexer.rules.indention;
 
 import alccemy.lexer.concepts;
 import alccemy.lexer.errors;
+import alccemy.lexer.line_index;
 import alccemy.lexer.token;
 import alccemy.lexer.text;
 import alccemy.lexer.unicode;
@@ -53,7 +54,7 @@ template <TokenSet TokenSetT, TokenSetT indention_token, TokenSetT dedention_tok
    }
 
    std::expected<RulesResult, ErrorType> handle_code_point(IndentionRuleState& state, Tokens<TokenSetT>& tokens,
-                                                           const UnicodeCodePoint& cp, const TextPos& position) const {
+                                                           const UnicodeCodePoint& cp, const TextOffset& offset) const {
       // Newline means new indention
       if (cp == '\n') {
          state.current_indention = 0;
@@ -64,13 +65,13 @@ template <TokenSet TokenSetT, TokenSetT indention_token, TokenSetT dedention_tok
       }
 
       if (state.current_indention && !state.indention_start) {
-         state.indention_start = position;
+         state.indention_start = offset.position();
       }
 
       if (state.current_indention &&
           std::find(m_indention_chars.begin(), m_indention_chars.end(), cp) != m_indention_chars.end()) {
          if (state.current_indention_char && cp != state.current_indention_char) {
-            return std::unexpected(ErrorType(MixedIndentionCharactersError{}, tokens, position, 1));
+            return std::unexpected(ErrorType(MixedIndentionCharactersError{}, tokens, offset.position(), 1));
          } else {
             state.current_indention_char = cp;
          }
@@ -91,7 +92,7 @@ template <TokenSet TokenSetT, TokenSetT indention_token, TokenSetT dedention_tok
                }
                // Ensure matching ident
                if (state.current_indention != state.indention_stack.back()) {
-                  return std::unexpected(ErrorType(MismatchedIndentionError{}, tokens, position, 1));
+                  return std::unexpected(ErrorType(MismatchedIndentionError{}, tokens, offset.position(), 1));
                }
             }
          }
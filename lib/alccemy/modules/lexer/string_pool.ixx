@@ -0,0 +1,78 @@
+module;
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+export module alccemy.lexer.string_pool;
+
+export namespace alccemy {
+
+//! Dense id of an interned spelling, ids are handed out from 0 in order of first appearance
+using SymbolId = uint32_t;
+
+//!
+//! Deduplicated storage of token spellings, each distinct spelling is stored
+//! once and known by a SymbolId, so equal spellings compare as equal integers
+//!
+class StringPool {
+ public:
+   StringPool() = default;
+
+   StringPool(const StringPool& other) : m_spellings(other.m_spellings) { reindex(); }
+
+   StringPool(StringPool&& other) = default;
+
+   StringPool& operator=(const StringPool& other) {
+      if (this != &other) {
+         m_spellings = other.m_spellings;
+         reindex();
+      }
+      return *this;
+   }
+
+   StringPool& operator=(StringPool&& other) = default;
+
+   //! Returns the id of spelling, adding it to the pool if it is new
+   SymbolId intern(std::string_view spelling) {
+      auto ite = m_ids.find(spelling);
+      if (ite != m_ids.end()) {
+         return ite->second;
+      }
+
+      auto id = static_cast<SymbolId>(m_spellings.size());
+      // Views into the deque stay valid as it grows, so they can key the index
+      const auto& stored = m_spellings.emplace_back(spelling);
+      m_ids.emplace(stored, id);
+      return id;
+   }
+
+   std::optional<SymbolId> find(std::string_view spelling) const {
+      auto ite = m_ids.find(spelling);
+      if (ite != m_ids.end()) {
+         return ite->second;
+      }
+      return std::nullopt;
+   }
+
+   std::string_view spelling(SymbolId id) const { return m_spellings.at(id); }
+
+   size_t size() const { return m_spellings.size(); }
+
+ private:
+   void reindex() {
+      m_ids.clear();
+      for (size_t i = 0; i < m_spellings.size(); ++i) {
+         m_ids.emplace(m_spellings[i], static_cast<SymbolId>(i));
+      }
+   }
+
+   std::deque<std::string> m_spellings;
+   std::unordered_map<std::string_view, SymbolId> m_ids;
+};
+
+} // namespace alccemy
@@ -1,9 +1,14 @@
 module;
 
+#include <limits>
+#include <optional>
+#include <utility>
 #include <vector>
 
 export module alccemy.lexer.tokenized_text;
 
+import alccemy.lexer.line_index;
+import alccemy.lexer.string_pool;
 import alccemy.lexer.unicode;
 import alccemy.lexer.token;
 
@@ -13,13 +18,40 @@ export namespace alccemy {
 //! Represents a set of text after being lexed, containing the tokens and the
 //! code points
 //!
+//! Tokens produced by Intern patterns also carry the SymbolId of their
+//! spelling in the string pool, and the line index resolves byte offsets into
+//! the source to lines
+//!
 template <typename TokenSet> class TokenizedText {
  public:
+   //! Marks tokens without a SymbolId
+   static constexpr SymbolId NO_SYMBOL = std::numeric_limits<SymbolId>::max();
+
    TokenizedText(const Tokens<TokenSet>& tokens) : m_tokens(tokens) {}
 
+   TokenizedText(Tokens<TokenSet> tokens, StringPool string_pool, std::vector<SymbolId> symbol_ids,
+                 LineIndex line_index = LineIndex())
+       : m_tokens(std::move(tokens)), m_string_pool(std::move(string_pool)), m_symbol_ids(std::move(symbol_ids)),
+         m_line_index(std::move(line_index)) {}
+
    const Tokens<TokenSet>& tokens() const { return m_tokens; }
 
+   const StringPool& string_pool() const { return m_string_pool; }
+
+   const LineIndex& line_index() const { return m_line_index; }
+
+   std::optional<SymbolId> symbol_id(size_t token_index) const {
+      if (token_index < m_symbol_ids.size() && m_symbol_ids[token_index] != NO_SYMBOL) {
+         return m_symbol_ids[token_index];
+      }
+      return std::nullopt;
+   }
+
  private:
    Tokens<TokenSet> m_tokens;
+   StringPool m_string_pool;
+   // Parallel to the tokens, empty when nothing was interned
+   std::vector<SymbolId> m_symbol_ids;
+   LineIndex m_line_index;
 };
 } // namespace alccemy
@@ -0,0 +1,303 @@
+module;
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+export module alccemy.parser.combinators;
+
+import alccemy.lexer.concepts;
+import alccemy.parser.concepts;
+import alccemy.parser.context;
+import alccemy.parser.nodes;
+import alccemy.parser.subparser;
+
+export namespace alccemy::parser {
+
+//!
+//! Expects a single token of the type
+//!
+template <auto token_type>
+   requires TokenSet<decltype(token_type)>
+class Is {
+ public:
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      return FirstSet<TokenSetT>::of(token_type);
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parent) {
+      static_assert(std::is_same_v<TokenSetT, decltype(token_type)>, "Is expects a token of the parsed token set");
+      if (parent.peek_type() == token_type) {
+         parent.advance();
+         return ParseResult(ParseResultType::Success, parent, NodeRange{});
+      }
+      parent.context().note_failure(parent.current_token_index());
+      return ParseResult(ParseResultType::Failure, parent, NodeRange{});
+   }
+};
+
+//!
+//! Expects each of its elements in turn, fails as soon as one of them does
+//!
+template <ParserElement... Ts> class Sequence {
+ public:
+   //! Elements after the first one that is not nullable are never looked at, so they may still be incomplete
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      if constexpr (sizeof...(Ts) == 0) {
+         return FirstSet<TokenSetT>::empty();
+      } else {
+         return sequence_first_set<TokenSetT, Ts...>();
+      }
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parent) {
+      size_t node_mark = parent.context().nodes().mark();
+      bool succeeded = (parse_element<Ts>(parent) && ...);
+      return ParseResult(succeeded ? ParseResultType::Success : ParseResultType::Failure, parent,
+                         parent.context().nodes().since(node_mark));
+   }
+
+ private:
+   template <TokenSet TokenSetT, ParserElement ElemT, ParserElement... OthersT>
+   static constexpr FirstSet<TokenSetT> sequence_first_set() {
+      constexpr FirstSet<TokenSetT> first = first_set_of<ElemT, TokenSetT>();
+      if constexpr (first.nullable() && sizeof...(OthersT) > 0) {
+         return first.with_nullable(false) | sequence_first_set<TokenSetT, OthersT...>();
+      } else {
+         return first;
+      }
+   }
+
+   template <ParserElement ElemT, TokenSet TokenSetT> static bool parse_element(Subparser<TokenSetT>& parent) {
+      return ElemT::parse(parent).succeeded();
+   }
+};
+
+//!
+//! Expects one of several elements, the first one in order that matches wins
+//!
+//! Each alternative is only tried if its FirstSet allows the next token, which is
+//! looked up in a table built at compile time per token set
+//!
+template <ParserElement... Ts> class AnyOf {
+ public:
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      return (FirstSet<TokenSetT>() | ... | first_set_of<Ts, TokenSetT>());
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parent) {
+      static_assert(sizeof...(Ts) <= 64, "AnyOf supports at most 64 alternatives");
+      static constexpr DispatchTable table = build_dispatch_table<TokenSetT>();
+
+      NodeBuffer& nodes = parent.context().nodes();
+      size_t node_mark = nodes.mark();
+      uint64_t viable = table.viable_for(static_cast<size_t>(parent.peek_type()));
+      bool matched = [&]<size_t... indicies>(std::index_sequence<indicies...>) {
+         return (try_alternative<indicies, Ts>(parent, viable, node_mark) || ...);
+      }(std::index_sequence_for<Ts...>{});
+
+      if (matched) {
+         return ParseResult(ParseResultType::Success, parent, nodes.since(node_mark));
+      }
+      parent.context().note_failure(parent.current_token_index());
+      return ParseResult(ParseResultType::Failure, parent, NodeRange{});
+   }
+
+ private:
+   //! For each tracked token type, a bitmask of the alternatives that could start with it
+   struct DispatchTable {
+      std::array<uint64_t, 256> by_type{};
+      //! The alternatives that could start with a type the first sets do not track
+      uint64_t untracked = 0;
+
+      constexpr uint64_t viable_for(size_t type) const { return type < by_type.size() ? by_type[type] : untracked; }
+   };
+
+   template <TokenSet TokenSetT> static constexpr DispatchTable build_dispatch_table() {
+      static_assert(FirstSet<TokenSetT>::CAPACITY == 256, "The dispatch table covers every tracked token type");
+      constexpr std::array<FirstSet<TokenSetT>, sizeof...(Ts)> first_sets{first_set_of<Ts, TokenSetT>()...};
+
+      DispatchTable table;
+      for (size_t i = 0; i < first_sets.size(); ++i) {
+         const FirstSet<TokenSetT>& first = first_sets[i];
+         for (size_t type = 0; type < table.by_type.size(); ++type) {
+            if (first.nullable() || first.contains_value(type)) {
+               table.by_type[type] |= uint64_t(1) << i;
+            }
+         }
+         if (first.nullable() || first.unbounded()) {
+            table.untracked |= uint64_t(1) << i;
+         }
+      }
+      return table;
+   }
+
+   template <size_t index, ParserElement ElemT, TokenSet TokenSetT>
+   static bool try_alternative(Subparser<TokenSetT>& parent, uint64_t viable, size_t node_mark) {
+      if ((viable & (uint64_t(1) << index)) == 0) {
+         return false;
+      }
+
+      Subparser<TokenSetT> child = parent.create_child();
+      ParseResult res = ElemT::parse(child);
+      if (res.succeeded()) {
+         parent.take_over_from(child);
+         return true;
+      }
+      parent.context().nodes().rollback(node_mark);
+      return false;
+   }
+};
+
+//!
+//! Expects T or nothing, does not try T where it is bound to fail
+//!
+template <ParserElement T> class Optional {
+ public:
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      return first_set_of<T, TokenSetT>().with_nullable(true);
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parent) {
+      constexpr FirstSet<TokenSetT> first = first_set_of<T, TokenSetT>();
+      if (first.rules_out(parent.peek_type())) {
+         return ParseResult(ParseResultType::Success, parent, NodeRange{});
+      }
+
+      NodeBuffer& nodes = parent.context().nodes();
+      size_t node_mark = nodes.mark();
+      Subparser<TokenSetT> child = parent.create_child();
+      ParseResult res = T::parse(child);
+      if (!res.succeeded()) {
+         nodes.rollback(node_mark);
+         return ParseResult(ParseResultType::Success, parent, NodeRange{});
+      }
+      parent.take_over_from(child);
+      return ParseResult(ParseResultType::Success, parent, nodes.since(node_mark));
+   }
+};
+
+//!
+//! Expects T any number of times, including none. Ends without trying T where it
+//! is bound to fail, and after a repeat of T that consumed nothing, as every
+//! further one would too
+//!
+template <ParserElement T> class Repeats {
+ public:
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      return first_set_of<T, TokenSetT>().with_nullable(true);
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parent) {
+      constexpr FirstSet<TokenSetT> first = first_set_of<T, TokenSetT>();
+      NodeBuffer& nodes = parent.context().nodes();
+      size_t node_mark = nodes.mark();
+      while (!first.rules_out(parent.peek_type())) {
+         size_t repeat_mark = nodes.mark();
+         Subparser<TokenSetT> child = parent.create_child();
+         ParseResult res = T::parse(child);
+         if (!res.succeeded()) {
+            nodes.rollback(repeat_mark);
+            break;
+         }
+         parent.take_over_from(child);
+         if (res.consumed() == 0) {
+            break;
+         }
+      }
+      return ParseResult(ParseResultType::Success, parent, nodes.since(node_mark));
+   }
+};
+
+//!
+//! Succeeds where T would, but consumes nothing and keeps none of T's nodes
+//!
+template <ParserElement T> class Peek {
+ public:
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      return first_set_of<T, TokenSetT>();
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parent) {
+      NodeBuffer& nodes = parent.context().nodes();
+      size_t node_mark = nodes.mark();
+      Subparser<TokenSetT> child = parent.create_child();
+      ParseResult res = T::parse(child);
+      nodes.rollback(node_mark);
+      return ParseResult(res.type(), parent, NodeRange{});
+   }
+};
+
+//!
+//! A block of T one level deeper than the code around it. The IndentionRule of the
+//! lexer already balances indent and dedent tokens, so no indention stack is needed
+//!
+template <auto indent, auto dedent, ParserElement T> using Indented = Sequence<Is<indent>, T, Is<dedent>>;
+
+//!
+//! Parses T as a single rule, producing a node of the kind that spans the tokens T consumed
+//! and has the nodes of T as its subtree
+//!
+//! If the parse context memoizes, the outcome is remembered per starting token, so the
+//! backtracking of AnyOf only ever parses the rule once from each token. The nodes
+//! stay in the node buffer, kept through the rollbacks, rather than being copied
+//! for every rule above
+//!
+template <auto kind, ParserElement T>
+   requires std::is_enum_v<decltype(kind)>
+class ParseRule {
+ public:
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      return first_set_of<T, TokenSetT>();
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parser) {
+      ParseContext<TokenSetT>& context = parser.context();
+      if (!context.options().memoize) {
+         return parse_rule(parser);
+      }
+
+      size_t start = parser.current_token_index();
+      if (MemoizedResult* memoized = context.find_memoized(&s_rule_id, start)) {
+         // Unless the nodes were overwritten since, in which case the rule is parsed again
+         if (std::optional<NodeRange> range = context.nodes().reuse(memoized->nodes)) {
+            memoized->nodes = context.nodes().keep(*range);
+            parser.resume_at(memoized->end);
+            return ParseResult(memoized->type, parser, *range);
+         }
+      }
+
+      ParseResult res = parse_rule(parser);
+      context.memoize(&s_rule_id, start,
+                      MemoizedResult{res.type(), parser.current_token_index(), context.nodes().keep(res.nodes())});
+      return res;
+   }
+
+ private:
+   static constexpr char s_rule_id = 0;
+
+   template <TokenSet TokenSetT> static ParseResult parse_rule(Subparser<TokenSetT>& parser) {
+      // The rule's node goes in front of the nodes of its children
+      NodeBuffer& nodes = parser.context().nodes();
+      size_t slot = nodes.reserve_slot();
+
+      Subparser<TokenSetT> child = parser.create_child();
+      ParseResult res = T::parse(child);
+      if (!res.succeeded()) {
+         nodes.rollback(slot);
+         return ParseResult(ParseResultType::Failure, parser, NodeRange{});
+      }
+
+      nodes.fill_slot(slot, Node{static_cast<uint32_t>(kind), static_cast<uint32_t>(child.start_token_index()),
+                                 static_cast<uint32_t>(child.consumed()),
+                                 static_cast<uint32_t>(nodes.mark() - slot - 1)});
+      parser.take_over_from(child);
+      return ParseResult(ParseResultType::Success, parser, nodes.since(slot));
+   }
+};
+
+} // namespace alccemy::parser
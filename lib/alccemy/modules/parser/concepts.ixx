@@ -0,0 +1,112 @@
+module;
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+export module alccemy.parser.concepts;
+
+import alccemy.lexer.concepts;
+
+export namespace alccemy::parser {
+
+//!
+//! Constraints that a parser element (a combinator or a rule) needs to fulfill
+//!
+//! Checking for parse() here would reject forward declared rules, which makes
+//! recursive grammars impossible, so anything is accepted
+//!
+template <typename T>
+concept ParserElement = true;
+
+//!
+//! The token types an element can succeed on when it is the next token, nullable
+//! if it can succeed whatever the next token is (such as by consuming nothing)
+//!
+//! Only token types with an underlying value below CAPACITY are tracked, an element
+//! that can start with any other type is unbounded and could start with anything
+//!
+template <TokenSet TokenSetT> class FirstSet {
+ public:
+   static constexpr size_t CAPACITY = 256;
+
+   static constexpr FirstSet of(TokenSetT type) {
+      FirstSet set;
+      size_t index = static_cast<size_t>(type);
+      if (index < CAPACITY) {
+         set.m_tokens[index / 64] |= uint64_t(1) << (index % 64);
+      } else {
+         set.m_unbounded = true;
+      }
+      return set;
+   }
+
+   //! The set of an element that nothing is known about
+   static constexpr FirstSet any() {
+      FirstSet set;
+      set.m_nullable = true;
+      set.m_unbounded = true;
+      return set;
+   }
+
+   //! The set of an element that always succeeds without consuming anything
+   static constexpr FirstSet empty() {
+      FirstSet set;
+      set.m_nullable = true;
+      return set;
+   }
+
+   constexpr bool nullable() const { return m_nullable; }
+
+   constexpr bool unbounded() const { return m_unbounded; }
+
+   constexpr bool contains(TokenSetT type) const { return contains_value(static_cast<size_t>(type)); }
+
+   //! Whether the set contains the token type with the underlying value
+   constexpr bool contains_value(size_t value) const {
+      return value < CAPACITY ? (m_tokens[value / 64] >> (value % 64)) & 1 : m_unbounded;
+   }
+
+   constexpr bool can_start_with(TokenSetT type) const { return m_nullable || m_unbounded || contains(type); }
+
+   //! Whether the element is bound to fail when the next token is of the type, so it need not be parsed at all
+   constexpr bool rules_out(TokenSetT type) const { return !can_start_with(type); }
+
+   constexpr FirstSet with_nullable(bool nullable) const {
+      FirstSet set = *this;
+      set.m_nullable = nullable;
+      return set;
+   }
+
+   constexpr FirstSet operator|(const FirstSet& r) const {
+      FirstSet set;
+      for (size_t i = 0; i < m_tokens.size(); ++i) {
+         set.m_tokens[i] = m_tokens[i] | r.m_tokens[i];
+      }
+      set.m_nullable = m_nullable || r.m_nullable;
+      set.m_unbounded = m_unbounded || r.m_unbounded;
+      return set;
+   }
+
+ private:
+   std::array<uint64_t, CAPACITY / 64> m_tokens{};
+   bool m_nullable = false;
+   bool m_unbounded = false;
+};
+
+//!
+//! The FirstSet of an element, elements that do not declare one through a static
+//! first_set<TokenSetT>() could start with anything
+//!
+//! Only evaluate this from within parse functions, where every rule is complete
+//! even if it was forward declared
+//!
+template <typename T, TokenSet TokenSetT> constexpr FirstSet<TokenSetT> first_set_of() {
+   if constexpr (requires { T::template first_set<TokenSetT>(); }) {
+      return T::template first_set<TokenSetT>();
+   } else {
+      return FirstSet<TokenSetT>::any();
+   }
+}
+
+} // namespace alccemy::parser
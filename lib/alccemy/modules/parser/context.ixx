@@ -0,0 +1,115 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+export module alccemy.parser.context;
+
+import alccemy.lexer.concepts;
+import alccemy.lexer.token;
+import alccemy.parser.nodes;
+
+export namespace alccemy::parser {
+
+//!
+//! Options controlling a single parse
+//!
+class ParseOptions {
+ public:
+   //! Remembers the outcome of each rule at each token, so backtracking never
+   //! parses the same rule from the same token twice, at the cost of keeping
+   //! every outcome alive for the parse
+   bool memoize = false;
+};
+
+//!
+//! How a parsing attempt ended
+//!
+enum class ParseResultType {
+   Failure,
+   Success,
+};
+
+//!
+//! The outcome of a rule at a token, with the token the rule left off at
+//!
+class MemoizedResult {
+ public:
+   ParseResultType type;
+   size_t end;
+   // Kept in the node buffer, where the rule put them
+   KeptRange nodes;
+};
+
+//!
+//! State shared by every subparser of a single parse
+//!
+template <TokenSet TokenSetT> class ParseContext {
+ public:
+   //! Unique per rule, the address of a tag the rule owns
+   using RuleId = const void*;
+
+   ParseContext(const Tokens<TokenSetT>& tokens, ParseOptions options = ParseOptions())
+       : m_tokens(tokens), m_options(options) {
+      // Rules only ever look at the type of a token, so the types are packed to
+      // not load whole tokens while parsing
+      m_token_types.reserve(tokens.size());
+      for (const auto& token : tokens) {
+         m_token_types.push_back(token.type());
+      }
+   }
+
+   const Tokens<TokenSetT>& tokens() const { return m_tokens; }
+
+   std::span<const TokenSetT> token_types() const { return m_token_types; }
+
+   const ParseOptions& options() const { return m_options; }
+
+   NodeBuffer& nodes() { return m_nodes; }
+
+   //! Records that a token did not match, the parse error is reported at the
+   //! furthest such token
+   void note_failure(size_t token_index) { m_furthest_failure = std::max(m_furthest_failure, token_index); }
+
+   size_t furthest_failure() const { return m_furthest_failure; }
+
+   //! The outcome of a rule from a token, or nullptr if it has not been parsed from there
+   MemoizedResult* find_memoized(RuleId rule, size_t token_index) {
+      auto ite = m_memo.find(MemoKey{rule, token_index});
+      return ite != m_memo.end() ? &ite->second : nullptr;
+   }
+
+   void memoize(RuleId rule, size_t token_index, MemoizedResult result) {
+      m_memo.insert_or_assign(MemoKey{rule, token_index}, std::move(result));
+   }
+
+   size_t memoized_count() const { return m_memo.size(); }
+
+ private:
+   struct MemoKey {
+      RuleId rule;
+      size_t token_index;
+
+      bool operator==(const MemoKey& other) const = default;
+   };
+
+   struct MemoKeyHash {
+      size_t operator()(const MemoKey& key) const {
+         return std::hash<RuleId>()(key.rule) ^ (std::hash<size_t>()(key.token_index) * 31);
+      }
+   };
+
+   const Tokens<TokenSetT>& m_tokens;
+   std::vector<TokenSetT> m_token_types;
+   ParseOptions m_options;
+   NodeBuffer m_nodes;
+   size_t m_furthest_failure = 0;
+   std::unordered_map<MemoKey, MemoizedResult, MemoKeyHash> m_memo;
+};
+
+} // namespace alccemy::parser
@@ -0,0 +1,166 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+export module alccemy.parser.nodes;
+
+export namespace alccemy::parser {
+
+//!
+//! A node of a parse tree, made by a ParseRule. Nodes are stored in pre-order, a
+//! node is followed by the nodes of its subtree, so they need no pointers
+//!
+class Node {
+ public:
+   //! The node kind the rule was declared with, as its underlying value
+   uint32_t kind;
+   uint32_t first_token;
+   uint32_t token_count;
+   //! How many of the nodes following this one are in its subtree
+   uint32_t descendants;
+
+   template <typename KindT> KindT kind_as() const { return static_cast<KindT>(kind); }
+
+   bool operator==(const Node& other) const = default;
+};
+
+//!
+//! A range of nodes in a NodeBuffer, from begin up to but not including end
+//!
+class NodeRange {
+ public:
+   size_t begin = 0;
+   size_t end = 0;
+
+   size_t size() const { return end - begin; }
+
+   bool operator==(const NodeRange& other) const = default;
+};
+
+//!
+//! Nodes kept for reuse through the rollbacks of the buffer, see NodeBuffer::keep
+//!
+class KeptRange {
+ public:
+   NodeRange range;
+   // The ranges kept before this one, a node written since has a larger stamp
+   uint32_t stamp = 0;
+};
+
+//!
+//! Every node of a parse, in a single buffer that rules append to as they
+//! succeed. A combinator marks the buffer before trying a child and rolls back to
+//! the mark if it discards the child, so a node is written once instead of being
+//! copied into the result of every rule above it
+//!
+//! The nodes of the ranges the memo holds on to are kept through rollbacks. They
+//! stay where they were until overwritten, so a rule parsed again where its nodes
+//! still are takes them back in place
+//!
+class NodeBuffer {
+ public:
+   size_t mark() const { return m_size; }
+
+   //! The nodes appended since the mark
+   NodeRange since(size_t mark) const { return NodeRange{mark, m_size}; }
+
+   void rollback(size_t mark) {
+      m_size = mark;
+      truncate(std::max(mark, m_kept));
+   }
+
+   void append(std::span<const Node> nodes) {
+      for (const Node& node : nodes) {
+         push(node);
+      }
+   }
+
+   //! Appends a placeholder for a node that has to precede its not yet parsed
+   //! subtree, it must later be filled in or rolled back
+   size_t reserve_slot() {
+      push(Node{0, 0, 0, 0});
+      return m_size - 1;
+   }
+
+   void fill_slot(size_t slot, const Node& node) {
+      m_nodes[slot] = node;
+      m_stamps[slot] = m_keeps;
+   }
+
+   //! Keeps the nodes of a range through later rollbacks, until they are
+   //! overwritten. The nodes past the kept ones are still dropped on a rollback
+   KeptRange keep(NodeRange range) {
+      m_kept = std::max(m_kept, range.end);
+      return KeptRange{range, m_keeps++};
+   }
+
+   //! Appends the nodes of a kept range again, and returns where they are now.
+   //! If the buffer was rolled back to just before them they are taken back
+   //! where they are, otherwise they are copied. nullopt if they were overwritten
+   std::optional<NodeRange> reuse(const KeptRange& kept) {
+      NodeRange range = kept.range;
+      if (range.end > m_nodes.size() ||
+          std::any_of(m_stamps.begin() + range.begin, m_stamps.begin() + range.end,
+                      [&](uint32_t stamp) { return stamp > kept.stamp; })) {
+         return std::nullopt;
+      }
+
+      if (range.begin == m_size) {
+         m_size = range.end;
+         return range;
+      }
+
+      size_t begin = m_size;
+      // Nodes past the end would be overwritten while copying them
+      std::vector<Node> copy(m_nodes.begin() + range.begin, m_nodes.begin() + range.end);
+      append(copy);
+      return NodeRange{begin, m_size};
+   }
+
+   std::span<const Node> view(NodeRange range) const {
+      return std::span<const Node>(m_nodes.data() + range.begin, range.size());
+   }
+
+   std::vector<Node> take() {
+      truncate(m_size);
+      m_stamps.clear();
+      return std::move(m_nodes);
+   }
+
+ private:
+   void push(const Node& node) {
+      if (m_size < m_nodes.size()) {
+         m_nodes[m_size] = node;
+         m_stamps[m_size] = m_keeps;
+      } else {
+         m_nodes.push_back(node);
+         m_stamps.push_back(m_keeps);
+      }
+      m_size += 1;
+   }
+
+   //! Drops the nodes past the end of the buffer from the given size on
+   void truncate(size_t size) {
+      if (m_nodes.size() > size) {
+         m_nodes.resize(size);
+         m_stamps.resize(size);
+      }
+   }
+
+   // The nodes of the buffer, followed by nodes that were rolled back but are kept
+   std::vector<Node> m_nodes;
+   // When each node was last written, as the number of ranges kept by then
+   std::vector<uint32_t> m_stamps;
+   size_t m_size = 0;
+   // The end of the kept ranges, rollbacks leave the nodes before it in place
+   size_t m_kept = 0;
+   uint32_t m_keeps = 0;
+};
+
+} // namespace alccemy::parser
@@ -0,0 +1,90 @@
+module;
+
+#include <cstddef>
+#include <exception>
+#include <expected>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+
+export module alccemy.parser;
+
+export import alccemy.parser.combinators;
+export import alccemy.parser.concepts;
+export import alccemy.parser.context;
+export import alccemy.parser.nodes;
+export import alccemy.parser.subparser;
+
+import alccemy.lexer.concepts;
+import alccemy.lexer.text;
+import alccemy.lexer.token;
+
+export namespace alccemy::parser {
+
+//!
+//! The nodes of a successful parse, in pre-order. Usually a single root node with
+//! everything else in its subtree, unless the root element is not a ParseRule
+//!
+class ParseTree {
+ public:
+   ParseTree(std::vector<Node> nodes) : m_nodes(std::move(nodes)) {}
+
+   const std::vector<Node>& nodes() const { return m_nodes; }
+
+   //! Indices of the direct children of the node at the index
+   std::vector<size_t> children(size_t index) const {
+      std::vector<size_t> children;
+      size_t end = index + 1 + m_nodes[index].descendants;
+      for (size_t child = index + 1; child < end; child += m_nodes[child].descendants + 1) {
+         children.push_back(child);
+      }
+      return children;
+   }
+
+ private:
+   std::vector<Node> m_nodes;
+};
+
+template <TokenSet TokenSetT> class ParserFailure : public std::exception {
+ public:
+   ParserFailure(size_t token_index, TextPos text_pos) : token_index(token_index), text_pos(text_pos) {
+      m_message = fmt::format("Parser failure at line {}, Col {}; Reason: Unexpected token", text_pos.line,
+                              text_pos.col);
+   }
+
+   const char* what() const noexcept override { return m_message.c_str(); }
+
+ public:
+   //! The furthest token that did not match what the grammar expected
+   size_t token_index;
+   TextPos text_pos;
+
+ private:
+   std::string m_message;
+};
+
+//!
+//! Parses the tokens as RootT, which has to consume every token up to the end of the file
+//!
+template <ParserElement RootT, TokenSet TokenSetT>
+std::expected<ParseTree, ParserFailure<TokenSetT>> parse(const Tokens<TokenSetT>& tokens,
+                                                         ParseOptions options = ParseOptions()) {
+   ParseContext<TokenSetT> context(tokens, options);
+   Subparser<TokenSetT> parser(context);
+   ParseResult res = RootT::parse(parser);
+   if (res.succeeded() && parser.peek_type() == TokenSetT::EndOfFile) {
+      return ParseTree(context.nodes().take());
+   } else if (res.succeeded()) {
+      context.note_failure(parser.current_token_index());
+   }
+
+   size_t failed_at = context.furthest_failure();
+   TextPos text_pos = failed_at < tokens.size()  ? tokens[failed_at].pos()
+                      : tokens.empty()           ? TextPos(0, 0, 0)
+                                                 : tokens.back().pos();
+   return std::unexpected(ParserFailure<TokenSetT>(failed_at, text_pos));
+}
+
+} // namespace alccemy::parser
@@ -0,0 +1,76 @@
+module;
+
+#include <cstddef>
+#include <span>
+
+export module alccemy.parser.subparser;
+
+import alccemy.lexer.concepts;
+import alccemy.parser.context;
+import alccemy.parser.nodes;
+
+export namespace alccemy::parser {
+
+//!
+//! A cursor into the tokens of a parse, each element parses with its own and the
+//! element that called it takes over where it left off if it keeps the result
+//!
+template <TokenSet TokenSetT> class Subparser {
+ public:
+   Subparser(ParseContext<TokenSetT>& context, size_t start = 0)
+       : m_context(&context), m_types(context.token_types()), m_start(start), m_current(start) {}
+
+   ParseContext<TokenSetT>& context() const { return *m_context; }
+
+   //! The type of the current token, EndOfFile past the end of the tokens
+   TokenSetT peek_type() const { return m_current < m_types.size() ? m_types[m_current] : TokenSetT::EndOfFile; }
+
+   void advance() { m_current += 1; }
+
+   size_t start_token_index() const { return m_start; }
+
+   size_t current_token_index() const { return m_current; }
+
+   size_t consumed() const { return m_current - m_start; }
+
+   //! A subparser starting at the current token of this one
+   Subparser create_child() const { return Subparser(*m_context, m_current); }
+
+   void take_over_from(const Subparser& child) { m_current = child.m_current; }
+
+   void resume_at(size_t token_index) { m_current = token_index; }
+
+ private:
+   ParseContext<TokenSetT>* m_context;
+   std::span<const TokenSetT> m_types;
+   size_t m_start;
+   size_t m_current;
+};
+
+//!
+//! Describes the result of a specific parsing attempt
+//!
+class ParseResult {
+ public:
+   using Type = ParseResultType;
+
+   template <TokenSet TokenSetT>
+   ParseResult(Type type, const Subparser<TokenSetT>& parser, NodeRange nodes)
+       : m_type(type), m_consumed(parser.consumed()), m_nodes(nodes) {}
+
+   Type type() const { return m_type; }
+
+   bool succeeded() const { return m_type == Type::Success; }
+
+   size_t consumed() const { return m_consumed; }
+
+   //! The nodes produced, only valid until the node buffer is rolled back past them
+   NodeRange nodes() const { return m_nodes; }
+
+ private:
+   Type m_type;
+   size_t m_consumed;
+   NodeRange m_nodes;
+};
+
+} // namespace alccemy::parser
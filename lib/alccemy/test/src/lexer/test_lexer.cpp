@@ -219,6 +219,33 @@ TEST_CASE("Basics") {
          REQUIRE(tokens[0] == Token(TestLexicon::B, TextPos(0, 0, 0), 2));
       }
    }
+   SECTION("Interning") {
+      auto lexer = create_lexer<TestLexicon>(PatternSet{Intern(Tokenize(Repeats(AnyOf("AB")), TestLexicon::A)),
+                                                        Tokenize(Text("C"), TestLexicon::C), Text(" ")});
+
+      SECTION("Equal Spellings Share Ids") {
+         auto text = lexer.lexUtf8("AB C BA AB").value();
+         auto& tokens = text.tokens();
+
+         REQUIRE(tokens.size() == 5);
+         REQUIRE(tokens[0] == Token(TestLexicon::A, TextPos(0, 0, 0), 2));
+         REQUIRE(text.symbol_id(0) == text.symbol_id(3));
+         REQUIRE(text.symbol_id(0) != text.symbol_id(2));
+         REQUIRE(text.symbol_id(1) == std::nullopt);
+         REQUIRE(text.symbol_id(4) == std::nullopt);
+
+         REQUIRE(text.string_pool().size() == 2);
+         REQUIRE(text.string_pool().spelling(*text.symbol_id(0)) == "AB");
+         REQUIRE(text.string_pool().spelling(*text.symbol_id(2)) == "BA");
+      }
+
+      SECTION("Nothing Interned") {
+         auto text = lexer.lexUtf8("C C").value();
+
+         REQUIRE(text.string_pool().size() == 0);
+         REQUIRE(text.symbol_id(0) == std::nullopt);
+      }
+   }
 
    SECTION("Sad Path") {
       auto lexer =
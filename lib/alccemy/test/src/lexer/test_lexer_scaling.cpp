@@ -0,0 +1,181 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+import alccemy.lexer;
+
+using namespace alccemy;
+
+namespace {
+enum class ScalingLexicon {
+   EndOfFile = 100,
+   A = 0,
+   AB,
+   Open,
+   Comment,
+   Number,
+   Dot,
+};
+
+//!
+//! Counts every step the lexer makes a pattern take, a deterministic stand in
+//! for the time spent lexing
+//!
+template <LexerPattern T> class Counted {
+ public:
+   Counted(const T& pattern, size_t& steps) : m_pattern(pattern), m_steps(&steps) {}
+
+   LexerResult check(UnicodeCodePoint cp, size_t index) {
+      *m_steps += 1;
+      return m_pattern.check(cp, index);
+   }
+
+   LexerResult terminate(size_t index) {
+      *m_steps += 1;
+      return m_pattern.terminate(index);
+   }
+
+   void memo_state(size_t index, MemoState& state) const { m_pattern.memo_state(index, state); }
+
+ private:
+   T m_pattern;
+   size_t* m_steps;
+};
+
+//!
+//! Lexes inputs of growing size and checks that the work done by the patterns
+//! grows linearly with it
+//!
+void require_linear_scaling(const std::function<size_t(size_t)>& steps_for_size) {
+   constexpr size_t base_size = 1000;
+
+   size_t previous_steps = steps_for_size(base_size);
+   for (size_t size = base_size * 2; size <= base_size * 16; size *= 2) {
+      size_t steps = steps_for_size(size);
+      // Doubling the input must at most roughly double the work, quadratic
+      // behaviour would quadruple it
+      REQUIRE(steps <= previous_steps * 5 / 2);
+      previous_steps = steps;
+   }
+}
+
+std::string repeat(const std::string& text, size_t count) {
+   std::string result;
+   result.reserve(text.size() * count);
+   for (size_t i = 0; i < count; ++i) {
+      result += text;
+   }
+   return result;
+}
+} // namespace
+
+TEST_CASE("Linear Scaling") {
+   SECTION("Failing Suffix After Long Run") {
+      // Every 'a' starts a run that only fails at the end of the text
+      auto steps_for_size = [](size_t size) {
+         size_t steps = 0;
+         auto lexer = create_lexer<ScalingLexicon>(PatternSet{
+             Tokenize(Counted(Pattern(Repeats(Text("a")), Text("b")), steps), ScalingLexicon::AB),
+             Tokenize(Counted(Text("a"), steps), ScalingLexicon::A),
+         });
+
+         auto tokens = lexer.lexUtf8(repeat("a", size)).value().tokens();
+         REQUIRE(tokens.size() == size + 1);
+         REQUIRE(tokens[size - 1] == Token(ScalingLexicon::A, TextPos(0, size - 1, size - 1), 1));
+         return steps;
+      };
+
+      require_linear_scaling(steps_for_size);
+   }
+
+   SECTION("Unterminated Comments") {
+      // Every opener starts a comment that never closes
+      auto steps_for_size = [](size_t size) {
+         size_t steps = 0;
+         auto lexer = create_lexer<ScalingLexicon>(PatternSet{
+             Tokenize(Counted(Pattern(Text("<"), Repeats<NotAnyOf, 0>(NotAnyOf(">")), Text(">")), steps),
+                      ScalingLexicon::Comment),
+             Tokenize(Counted(Text("<"), steps), ScalingLexicon::Open),
+         });
+
+         auto tokens = lexer.lexUtf8(repeat("<", size)).value().tokens();
+         REQUIRE(tokens.size() == size + 1);
+         REQUIRE(tokens[0] == Token(ScalingLexicon::Open, TextPos(0, 0, 0), 1));
+         return steps;
+      };
+
+      require_linear_scaling(steps_for_size);
+   }
+
+   SECTION("Dotted Numbers") {
+      auto steps_for_size = [](size_t size) {
+         size_t steps = 0;
+         auto lexer = create_lexer<ScalingLexicon>(PatternSet{
+             Tokenize(Counted(Pattern(Repeats(AnyOf("0123456789")), Repeats<Text, 0, 1>(Text(".")),
+                                      Repeats<AnyOf, 0>(AnyOf("0123456789"))),
+                              steps),
+                      ScalingLexicon::Number),
+             Tokenize(Counted(Text("."), steps), ScalingLexicon::Dot),
+         });
+
+         auto tokens = lexer.lexUtf8(repeat("1.2.", size)).value().tokens();
+         REQUIRE(tokens.size() == size * 2 + 1);
+         REQUIRE(tokens[0] == Token(ScalingLexicon::Number, TextPos(0, 0, 0), 3));
+         REQUIRE(tokens[1] == Token(ScalingLexicon::Dot, TextPos(0, 3, 3), 1));
+         return steps;
+      };
+
+      require_linear_scaling(steps_for_size);
+   }
+}
+
+TEST_CASE("Memo States") {
+   SECTION("Composite States Keep Every Word") {
+      Pattern pattern(Text("ab"), Text("cd"));
+      MemoState fresh;
+      pattern.memo_state(0, fresh);
+
+      pattern.check('a', 0);
+      MemoState in_first;
+      pattern.memo_state(1, in_first);
+
+      pattern.check('b', 1);
+      MemoState in_second;
+      pattern.memo_state(2, in_second);
+
+      REQUIRE(std::vector<size_t>(fresh.words().begin(), fresh.words().end()) == std::vector<size_t>{0, 0});
+      REQUIRE(std::vector<size_t>(in_first.words().begin(), in_first.words().end()) == std::vector<size_t>{0, 1});
+      REQUIRE(std::vector<size_t>(in_second.words().begin(), in_second.words().end()) == std::vector<size_t>{1, 0});
+   }
+
+   SECTION("Failed Parts Push Only Their Flag") {
+      Patterns patterns(Text("ab"), Text("cd"));
+      patterns.check('a', 0);
+
+      MemoState state;
+      patterns.memo_state(1, state);
+      REQUIRE(std::vector<size_t>(state.words().begin(), state.words().end()) == std::vector<size_t>{0, 1, 1});
+   }
+}
+
+TEST_CASE("Adversarial Lexing Benchmarks", "[.][benchmark]") {
+   constexpr size_t size = 64 * 1024;
+
+   auto run_lexer = create_lexer<ScalingLexicon>(PatternSet{
+       Tokenize(Pattern(Repeats(Text("a")), Text("b")), ScalingLexicon::AB),
+       Tokenize(Text("a"), ScalingLexicon::A),
+   });
+   auto comment_lexer = create_lexer<ScalingLexicon>(PatternSet{
+       Tokenize(Pattern(Text("<"), Repeats<NotAnyOf, 0>(NotAnyOf(">")), Text(">")), ScalingLexicon::Comment),
+       Tokenize(Text("<"), ScalingLexicon::Open),
+   });
+
+   auto run_text = repeat("a", size);
+   auto comment_text = repeat("<", size);
+
+   BENCHMARK("Failing Suffix After Long Run") { return run_lexer.lexUtf8(run_text).has_value(); };
+   BENCHMARK("Unterminated Comments") { return comment_lexer.lexUtf8(comment_text).has_value(); };
+}
@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+import alccemy.lexer;
+
+using namespace alccemy;
+
+TEST_CASE("Line Index") {
+   std::string text = "ab\n" + as_utf8(0x0001F0A1) + "c\n\nd";
+   LineIndex index(text);
+
+   SECTION("Line Starts") {
+      REQUIRE(index.line_count() == 4);
+      REQUIRE(index.line_start(0) == 0);
+      REQUIRE(index.line_start(1) == 3);
+      REQUIRE(index.line_start(2) == 9);
+      REQUIRE(index.line_start(3) == 10);
+   }
+
+   SECTION("Line Of") {
+      REQUIRE(index.line_of(0) == 0);
+      REQUIRE(index.line_of(2) == 0);
+      REQUIRE(index.line_of(3) == 1);
+      REQUIRE(index.line_of(8) == 1);
+      REQUIRE(index.line_of(9) == 2);
+      REQUIRE(index.line_of(11) == 3);
+   }
+
+   SECTION("Positions") {
+      REQUIRE(index.position(text, 1) == TextPos(0, 1, 1));
+      REQUIRE(index.position(text, 7) == TextPos(1, 1, 7));
+      REQUIRE(index.position(text, 10) == TextPos(3, 0, 10));
+      REQUIRE(index.position(text, 11) == TextPos(3, 1, 11));
+   }
+
+   SECTION("Cursor") {
+      LineCursor cursor(index, text);
+
+      REQUIRE(cursor.position(7) == TextPos(1, 1, 7));
+      REQUIRE(cursor.position(8) == TextPos(1, 2, 8));
+      REQUIRE(cursor.position(3) == TextPos(1, 0, 3));
+      REQUIRE(cursor.position(1) == TextPos(0, 1, 1));
+      REQUIRE(cursor.position(11) == TextPos(3, 1, 11));
+   }
+
+   SECTION("No Newlines") {
+      LineIndex single_line("abc");
+
+      REQUIRE(single_line.line_count() == 1);
+      REQUIRE(single_line.line_of(3) == 0);
+   }
+}
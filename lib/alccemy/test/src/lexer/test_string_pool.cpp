@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+import alccemy.lexer;
+
+using namespace alccemy;
+
+TEST_CASE("String Pool") {
+   StringPool pool;
+
+   SECTION("Interning") {
+      auto foo = pool.intern("foo");
+      auto bar = pool.intern("bar");
+
+      REQUIRE(foo == 0);
+      REQUIRE(bar == 1);
+      REQUIRE(pool.intern(std::string("foo")) == foo);
+      REQUIRE(pool.size() == 2);
+      REQUIRE(pool.spelling(foo) == "foo");
+      REQUIRE(pool.spelling(bar) == "bar");
+   }
+
+   SECTION("Find") {
+      auto foo = pool.intern("foo");
+
+      REQUIRE(pool.find("foo") == foo);
+      REQUIRE(pool.find("fo") == std::nullopt);
+      REQUIRE(pool.size() == 1);
+   }
+
+   SECTION("Spellings Outlive Growth") {
+      auto first = pool.spelling(pool.intern("first"));
+      for (size_t i = 0; i < 1000; ++i) {
+         pool.intern(std::to_string(i));
+      }
+
+      REQUIRE(first == "first");
+      REQUIRE(pool.find("first") == 0);
+   }
+
+   SECTION("Copies Are Independent") {
+      pool.intern("foo");
+      StringPool copy = pool;
+      copy.intern("bar");
+
+      REQUIRE(copy.find("foo") == 0);
+      REQUIRE(copy.find("bar") == 1);
+      REQUIRE(pool.find("bar") == std::nullopt);
+   }
+}
@@ -0,0 +1,263 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+import alccemy.lexer;
+import alccemy.parser;
+
+// The lexer has patterns named like some of the combinators, so only what the tests need of it is brought in
+using alccemy::create_lexer;
+using alccemy::PatternSet;
+using alccemy::Text;
+using alccemy::TextPos;
+using alccemy::Token;
+using alccemy::Tokenize;
+using alccemy::Tokens;
+using alccemy::TokenSet;
+using namespace alccemy::parser;
+
+namespace {
+enum class TestLexicon {
+   A,
+   B,
+   C,
+   Open,
+   Close,
+   Indent = 102,
+   Dedent = 103,
+   EndOfFile = 101,
+   // Past what first sets track
+   Far = 300,
+};
+
+enum class Syntax {
+   Item,
+   Group,
+   List,
+};
+
+Tokens<TestLexicon> tokens_of(std::initializer_list<TestLexicon> types) {
+   Tokens<TestLexicon> tokens;
+   for (auto type : types) {
+      tokens.push_back(Token(type, TextPos(0, tokens.size(), tokens.size()), 1));
+   }
+   tokens.push_back(Token(TestLexicon::EndOfFile, TextPos(0, tokens.size(), tokens.size()), 0));
+   return tokens;
+}
+
+//! Counts how often it is parsed, to see which alternatives were tried
+class CountedA {
+ public:
+   static inline int parses = 0;
+
+   template <TokenSet TokenSetT> static constexpr FirstSet<TokenSetT> first_set() {
+      return FirstSet<TokenSetT>::of(TestLexicon::A);
+   }
+
+   template <TokenSet TokenSetT> static ParseResult parse(Subparser<TokenSetT>& parser) {
+      parses += 1;
+      return Is<TestLexicon::A>::parse(parser);
+   }
+};
+
+using Item = ParseRule<Syntax::Item, AnyOf<Is<TestLexicon::A>, Is<TestLexicon::B>>>;
+
+struct List;
+using Group = ParseRule<Syntax::Group, Sequence<Is<TestLexicon::Open>, List, Is<TestLexicon::Close>>>;
+struct List : ParseRule<Syntax::List, Repeats<AnyOf<Item, Group>>> {};
+} // namespace
+
+TEST_CASE("Parser Combinators") {
+   SECTION("Sequence") {
+      using Grammar = Sequence<Is<TestLexicon::A>, Is<TestLexicon::B>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::B})).has_value());
+      REQUIRE_FALSE(parse<Grammar>(tokens_of({TestLexicon::B, TestLexicon::A})).has_value());
+      REQUIRE_FALSE(parse<Grammar>(tokens_of({TestLexicon::A})).has_value());
+   }
+
+   SECTION("Must Reach End Of File") {
+      auto res = parse<Is<TestLexicon::A>>(tokens_of({TestLexicon::A, TestLexicon::A}));
+
+      REQUIRE_FALSE(res.has_value());
+      REQUIRE(res.error().token_index == 1);
+   }
+
+   SECTION("Optional") {
+      using Grammar = Sequence<Optional<Is<TestLexicon::A>>, Is<TestLexicon::B>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::B})).has_value());
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::B})).has_value());
+      REQUIRE_FALSE(parse<Grammar>(tokens_of({TestLexicon::C, TestLexicon::B})).has_value());
+   }
+
+   SECTION("Repeats") {
+      using Grammar = Sequence<Repeats<Is<TestLexicon::A>>, Is<TestLexicon::B>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::B})).has_value());
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::A, TestLexicon::A, TestLexicon::B})).has_value());
+   }
+
+   SECTION("Repeats Of Something Empty End") {
+      using Grammar = Repeats<Optional<Is<TestLexicon::A>>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({})).has_value());
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::A})).has_value());
+   }
+
+   SECTION("Peek") {
+      using Grammar = Sequence<Peek<Is<TestLexicon::A>>, Is<TestLexicon::A>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A})).has_value());
+      REQUIRE_FALSE(parse<Grammar>(tokens_of({TestLexicon::B})).has_value());
+   }
+
+   SECTION("AnyOf Takes The First Match") {
+      using Grammar = AnyOf<Is<TestLexicon::A>, Sequence<Is<TestLexicon::A>, Is<TestLexicon::B>>>;
+
+      REQUIRE_FALSE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::B})).has_value());
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A})).has_value());
+   }
+
+   SECTION("AnyOf Only Tries Alternatives That Can Start") {
+      CountedA::parses = 0;
+      using Grammar = AnyOf<CountedA, Is<TestLexicon::B>, Sequence<CountedA, Is<TestLexicon::C>>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::B})).has_value());
+      REQUIRE(CountedA::parses == 0);
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A})).has_value());
+      REQUIRE(CountedA::parses == 1);
+   }
+
+   SECTION("Memoized Rules Parse Once Per Token") {
+      CountedA::parses = 0;
+      using Counted = ParseRule<Syntax::Item, CountedA>;
+      using Grammar = AnyOf<Sequence<Counted, Is<TestLexicon::C>>, Sequence<Counted, Is<TestLexicon::B>>>;
+      ParseOptions options;
+      options.memoize = true;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::B})).has_value());
+      REQUIRE(CountedA::parses == 2);
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::B}), options).has_value());
+      REQUIRE(CountedA::parses == 3);
+   }
+
+   SECTION("Token Types Past Those Tracked") {
+      using Grammar = Sequence<Repeats<AnyOf<Is<TestLexicon::Far>, Is<TestLexicon::A>>>, Is<TestLexicon::B>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::Far, TestLexicon::A, TestLexicon::Far, TestLexicon::B})).has_value());
+      REQUIRE_FALSE(parse<Grammar>(tokens_of({TestLexicon::Far, TestLexicon::C})).has_value());
+   }
+
+   SECTION("Indented") {
+      using Grammar = Sequence<Is<TestLexicon::A>, Indented<TestLexicon::Indent, TestLexicon::Dedent, Repeats<Item>>>;
+
+      REQUIRE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::Indent, TestLexicon::B, TestLexicon::A,
+                                        TestLexicon::Dedent}))
+                  .has_value());
+      REQUIRE_FALSE(parse<Grammar>(tokens_of({TestLexicon::A, TestLexicon::B})).has_value());
+   }
+}
+
+TEST_CASE("Parse Trees") {
+   // A ( B ( ) A ) B
+   auto tokens = tokens_of({TestLexicon::A, TestLexicon::Open, TestLexicon::B, TestLexicon::Open, TestLexicon::Close,
+                            TestLexicon::A, TestLexicon::Close, TestLexicon::B});
+
+   SECTION("Nodes In Pre-Order") {
+      auto tree = parse<List>(tokens).value();
+      const auto& nodes = tree.nodes();
+
+      REQUIRE(nodes.size() == 9);
+      REQUIRE(nodes[0] == Node{static_cast<uint32_t>(Syntax::List), 0, 8, 8});
+      REQUIRE(nodes[1] == Node{static_cast<uint32_t>(Syntax::Item), 0, 1, 0});
+      REQUIRE(nodes[2] == Node{static_cast<uint32_t>(Syntax::Group), 1, 6, 5});
+      REQUIRE(nodes[3] == Node{static_cast<uint32_t>(Syntax::List), 2, 4, 4});
+      REQUIRE(nodes[4].kind_as<Syntax>() == Syntax::Item);
+      REQUIRE(nodes[5] == Node{static_cast<uint32_t>(Syntax::Group), 3, 2, 1});
+      REQUIRE(nodes[6] == Node{static_cast<uint32_t>(Syntax::List), 4, 0, 0});
+      REQUIRE(nodes[7] == Node{static_cast<uint32_t>(Syntax::Item), 5, 1, 0});
+      REQUIRE(nodes[8] == Node{static_cast<uint32_t>(Syntax::Item), 7, 1, 0});
+
+      REQUIRE(tree.children(0) == std::vector<size_t>{1, 2, 8});
+      REQUIRE(tree.children(3) == std::vector<size_t>{4, 5, 7});
+      REQUIRE(tree.children(6).empty());
+   }
+
+   SECTION("Memoized Parse Builds The Same Tree") {
+      ParseOptions options;
+      options.memoize = true;
+
+      REQUIRE(parse<List>(tokens, options).value().nodes() == parse<List>(tokens).value().nodes());
+   }
+
+   SECTION("Failure At The Furthest Token") {
+      // A ( B C )
+      auto res = parse<List>(tokens_of({TestLexicon::A, TestLexicon::Open, TestLexicon::B, TestLexicon::C,
+                                        TestLexicon::Close}));
+
+      REQUIRE_FALSE(res.has_value());
+      REQUIRE(res.error().token_index == 3);
+      REQUIRE(res.error().text_pos == TextPos(0, 3, 3));
+   }
+}
+
+TEST_CASE("Node Buffer") {
+   NodeBuffer nodes;
+   auto node = [](uint32_t token) { return Node{static_cast<uint32_t>(Syntax::Item), token, 1, 0}; };
+
+   std::vector<Node> first{node(0), node(1)};
+   nodes.append(first);
+   size_t mark = nodes.mark();
+   std::vector<Node> second{node(2), node(3)};
+   nodes.append(second);
+   KeptRange kept = nodes.keep(nodes.since(mark));
+
+   SECTION("Rollback Leaves Kept Nodes In Place") {
+      nodes.rollback(mark);
+      REQUIRE(nodes.mark() == mark);
+
+      auto range = nodes.reuse(kept);
+      REQUIRE(range == kept.range);
+      REQUIRE(nodes.mark() == 4);
+      REQUIRE(nodes.view(*range)[0] == node(2));
+   }
+
+   SECTION("Kept Nodes Elsewhere Are Copied") {
+      nodes.rollback(mark - 1);
+
+      auto range = nodes.reuse(kept);
+      REQUIRE(range == NodeRange{1, 3});
+      REQUIRE(nodes.view(*range)[0] == node(2));
+      REQUIRE(nodes.view(*range)[1] == node(3));
+   }
+
+   SECTION("Overwritten Nodes Are Not Reused") {
+      nodes.rollback(mark);
+      std::vector<Node> other{node(5)};
+      nodes.append(other);
+      nodes.rollback(mark);
+
+      REQUIRE_FALSE(nodes.reuse(kept).has_value());
+   }
+
+   SECTION("Only The Nodes Of The Buffer Are Taken") {
+      nodes.rollback(mark);
+
+      REQUIRE(nodes.take() == first);
+   }
+}
+
+TEST_CASE("Parse Lexed Text") {
+   auto lexer = create_lexer<TestLexicon>(PatternSet{
+       Tokenize(Text("a"), TestLexicon::A), Tokenize(Text("b"), TestLexicon::B),
+       Tokenize(Text("("), TestLexicon::Open), Tokenize(Text(")"), TestLexicon::Close), alccemy::AnyOf(" ")});
+
+   auto tokens = lexer.lexUtf8("a (b a) b").value().tokens();
+   auto tree = parse<List>(tokens).value();
+
+   REQUIRE(tree.nodes().size() == 7);
+   REQUIRE(tree.children(0).size() == 3);
+}
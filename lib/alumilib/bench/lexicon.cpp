@@ -0,0 +1,13 @@
+#include "alumi/lexer/alumi_lexicon.h"
+
+namespace alumi
+{
+   //!
+   //! Lexes with the default lexicon, so this translation unit instantiates every one of its patterns.
+   //! Only compiled for the alumilib_compile_times benchmark
+   //!
+   LexedText lex_with_default_lexicon(std::u8string_view text)
+   {
+      return default_lexer.lex(text);
+   }
+}
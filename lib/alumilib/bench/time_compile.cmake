@@ -0,0 +1,31 @@
+# Compiler launcher of the alumilib_compile_times benchmark. Runs the compile command given after -- and prints
+# how long it took, for the source file it compiled
+#   cmake -P time_compile.cmake -- <compiler> <arguments>...
+
+set(compile_command)
+set(source "")
+set(after_separator OFF)
+math(EXPR last_argument "${CMAKE_ARGC} - 1")
+foreach(index RANGE ${last_argument})
+    set(argument "${CMAKE_ARGV${index}}")
+    if (after_separator)
+        list(APPEND compile_command "${argument}")
+        if (argument MATCHES "\\.(cpp|ixx)$")
+            set(source "${argument}")
+        endif()
+    elseif (argument STREQUAL "--")
+        set(after_separator ON)
+    endif()
+endforeach()
+
+string(TIMESTAMP start "%s%f")
+execute_process(COMMAND ${compile_command} RESULT_VARIABLE result)
+string(TIMESTAMP end "%s%f")
+
+math(EXPR elapsed_ms "(${end} - ${start}) / 1000")
+get_filename_component(source_name "${source}" NAME)
+message("${source_name}: ${elapsed_ms} ms")
+
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Compiling ${source_name} failed")
+endif()
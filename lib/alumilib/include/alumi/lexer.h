@@ -2,9 +2,15 @@
 
 #include "alumi/lexer/lexer_detail.h"
 #include "alumi/lexer/lexed_text.h"
+#include "alumi/lexer/literal_table.h"
+
+#include <utf8cpp/utf8.h>
 
 #include <vector>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
 
 namespace alumi 
 {
@@ -68,6 +74,11 @@ namespace alumi
    ///
    /// Tokensizes one source
    ///
+   /// Every pattern still running sees each code point once, and the longest
+   /// completed token wins. Once all patterns are done the lexer steps back to
+   /// the end of that token, so lexing stays linear as long as patterns fail
+   /// within a few code points of where they stop matching, as the ones of the
+   /// alumi lexicon do
    /// 
    template <LexerPattern... PatternTs>
    class Lexer
@@ -78,28 +89,65 @@ namespace alumi
       {
       }
 
-      LexedText lex(const std::vector<UnicodeCodePoint>& text)
+      //!
+      //! Tokenizes UTF-8 source text
+      //! 
+      //! Token positions and sizes are in bytes, columns count the bytes 
+      //! from the start of the line
+      //! 
+      LexedText lex(std::u8string_view text)
+      {
+         return lex(text, [](const Tokens&) {});
+      }
+
+      //!
+      //! Tokenizes UTF-8 source text, handing on the tokens while lexing. on_tokens is called with the tokens
+      //! so far whenever a line starts at column zero, as every token before it is final by then, and once
+      //! more with all of them at the end
+      //! 
+      template<typename OnTokensT>
+      LexedText lex(std::u8string_view text, OnTokensT&& on_tokens)
       {
          static const std::vector<UnicodeCodePoint> indention_chars({ 0x20, 0x09 });
 
          reset();
 
          bool is_indenting = true;
-         size_t last_indent_chars = 0;
-         std::optional<char> indent_char;
+         std::optional<UnicodeCodePoint> indent_char;
 
          Tokens tokens;
+         LiteralTable literals;
+         SymbolTable symbols;
+         // Byte offsets into text
          size_t pos = 0;
          size_t cur_token_start = 0;
-         size_t line = 0;
          size_t line_start = 0;
+         // Code points fed to the patterns for the current token
+         size_t token_index = 0;
+         size_t line = 0;
 
-         auto handle_lexer_result = [&](const LexerResult& res)
+         // consumed_end is the offset just past the last code point passed to the patterns
+         auto handle_lexer_result = [&](const LexerResult& res, size_t consumed_end)
          {
             if (res.type == LexerResults::Completed)
             {
-               pos += 1 - res.backtrack_cols;
+               // Literal values are parsed and symbols interned as soon as their
+               // token is done, while the text is still in cache
+               if (!tokens.empty() && tokens.back().pos().byte_index() == cur_token_start)
+               {
+                  if (tokens.back().type() == TokenType::Literal)
+                  {
+                     record_literal(text, tokens, literals);
+                  }
+                  else if (tokens.back().type() == TokenType::Symbol)
+                  {
+                     const Token& token = tokens.back();
+                     symbols.add(tokens.size() - 1, text.substr(token.pos().byte_index(), token.size()));
+                  }
+               }
+               pos = retreat(text, consumed_end, res.backtrack_cols);
                cur_token_start = pos;
+               token_index = 0;
                reset();
             }
             else if (res.type == LexerResults::Failed)
@@ -109,19 +157,28 @@ namespace alumi
             }
             else
             {
-               pos += 1 - res.backtrack_cols;
+               token_index += (consumed_end > pos ? 1 : 0);
+               token_index -= res.backtrack_cols;
+               pos = retreat(text, consumed_end, res.backtrack_cols);
             }
          };
 
          while (pos < text.size())
          {
-            auto character = text[pos];
+            const char8_t* next = text.data() + pos;
+            UnicodeCodePoint character = utf8::next(next, text.data() + text.size());
+            size_t next_pos = next - text.data();
             if (character == 0x0a) // Newline
             {
                if (cur_token_start < pos && !is_indenting)
                {
-                  LexerResult res = terminate_codepoint(cur_token_start, pos - cur_token_start, tokens, line, cur_token_start - line_start, pos - line_start);
-                  handle_lexer_result(res);
+                  LexerResult res = terminate_codepoint(text, cur_token_start, token_index, tokens, line, line_start, pos);
+                  handle_lexer_result(res, pos);
+                  if (text[pos] != 0x0a)
+                  {
+                     // The completed token was shorter than the line, lex the rest of it
+                     continue;
+                  }
                }
 
                tokens.push_back(Token(TokenType::Linebreak, TextPos(line, pos - line_start, pos), 1));
@@ -143,26 +200,29 @@ namespace alumi
                   {
                      throw LexerFailure(LexerFailure::Reason::MismatchedIndentionCharacters, tokens, TextPos(line, pos - line_start, cur_token_start), pos);
                   }
+                  if (pos == line_start)
+                  {
+                     on_tokens(std::as_const(tokens));
+                  }
                   tokens.push_back(Token(TokenType::Indent, TextPos(line, 0, line_start), pos - line_start));
                   is_indenting = false;
                   cur_token_start = pos;
+                  token_index = 0;
                }
                else
                {
-                  pos += 1;
+                  pos = next_pos;
                   continue;
                }
             }
 
-           
-            LexerResult res = handle_codepoint(character, cur_token_start, pos - cur_token_start, tokens, line, cur_token_start - line_start, pos - line_start);
-            handle_lexer_result(res);
-
+            LexerResult res = handle_codepoint(character, text, cur_token_start, token_index, tokens, line, line_start, next_pos);
+            handle_lexer_result(res, next_pos);
          }
          if (cur_token_start < pos && !is_indenting)
          {
-            LexerResult res = terminate_codepoint(cur_token_start, pos - cur_token_start, tokens, line, cur_token_start - line_start, pos - line_start);
-            handle_lexer_result(res);
+            LexerResult res = terminate_codepoint(text, cur_token_start, token_index, tokens, line, line_start, pos);
+            handle_lexer_result(res, pos);
          }
          // Ensure that there is a final end of line token in order for the presence of terminating newline to not affect compiler behaviour
          if (tokens.size() == 0 || tokens.back().type() != TokenType::Linebreak)
@@ -170,9 +230,39 @@ namespace alumi
             tokens.push_back(Token(TokenType::Linebreak, TextPos(line, cur_token_start - line_start, cur_token_start), 0));
          }
          tokens.push_back(Token(TokenType::EndOfFile, TextPos(line, pos - line_start, pos), 0));
-         return LexedText(text, tokens);
+         on_tokens(std::as_const(tokens));
+         return LexedText(std::u8string(text), tokens, std::move(literals), std::move(symbols));
+      }
+
+      //! Tokenizes source already decoded into code points, it is stored as UTF-8
+      LexedText lex(const std::vector<UnicodeCodePoint>& text)
+      {
+         return lex(to_utf8(text));
       }
    private:
+      static void record_literal(std::u8string_view text, const Tokens& tokens, LiteralTable& literals)
+      {
+         const Token& token = tokens.back();
+         auto value = parse_literal(text.substr(token.pos().byte_index(), token.size()));
+         if (value)
+         {
+            literals.add(tokens.size() - 1, *value);
+         }
+      }
+
+      //! Steps back over code_points code points from the byte offset pos
+      static size_t retreat(std::u8string_view text, size_t pos, size_t code_points)
+      {
+         for (size_t i = 0; i < code_points && pos > 0; ++i)
+         {
+            do
+            {
+               pos -= 1;
+            } while (pos > 0 && (text[pos] & 0xC0) == 0x80);
+         }
+         return pos;
+      }
+
       class CompletePattern
       {
       public:
@@ -183,6 +273,7 @@ namespace alumi
 
          }
 
+         //! Code points into the token where the match ends, exclusive
          size_t end_pos;
          std::optional<Token> token;
       };
@@ -208,33 +299,48 @@ namespace alumi
          return std::nullopt;
       }
 
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if<I == sizeof...(PatternTs), LexerResult>::type
-         handle_codepoint(UnicodeCodePoint cp, size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t col_start, size_t col_end)
+      //! Feeds the code point to every pattern still running, in order, until the last of them finishes
+      LexerResult handle_codepoint(UnicodeCodePoint cp, std::u8string_view text, size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t line_start, size_t next_pos)
       {
-         return LexerResult(LexerResults::Continue, 0);
+         LexerResult res(LexerResults::Continue, 0);
+         [&, this]<std::size_t... Is>(std::index_sequence<Is...>)
+         {
+            (handle_pattern<Is>(cp, text, token_start_index, index, tokens, line, line_start, next_pos, res) || ...);
+         }(std::index_sequence_for<PatternTs...>());
+         return res;
+      }
+
+      LexerResult terminate_codepoint(std::u8string_view text, size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t line_start, size_t end_pos)
+      {
+         LexerResult res(LexerResults::Failed, 0);
+         [&, this]<std::size_t... Is>(std::index_sequence<Is...>)
+         {
+            (terminate_pattern<Is>(text, token_start_index, index, tokens, line, line_start, end_pos, res) || ...);
+         }(std::index_sequence_for<PatternTs...>());
+         return res;
       }
 
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if < I < sizeof...(PatternTs), LexerResult>::type
-         handle_codepoint(UnicodeCodePoint cp, size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t col_start, size_t col_end)
+      //! @returns true once every pattern is done, in which case the outcome of the token is written to finished
+      template<std::size_t I>
+      bool handle_pattern(UnicodeCodePoint cp, std::u8string_view text, size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t line_start, size_t next_pos, LexerResult& finished)
       {
          if (!m_done[I])
          {
             auto res = std::get<I>(m_pattern).check(cp, index);
             if (res.type == LexerResults::Completed)
             {
-               auto token = make_token(std::get<I>(m_pattern), line, col_start, (col_end + 1 - res.backtrack_cols), token_start_index);
+               size_t token_end = retreat(text, next_pos, res.backtrack_cols);
+               auto token = make_token(std::get<I>(m_pattern), line, token_start_index - line_start, token_end - line_start, token_start_index);
                if (m_best != std::nullopt && m_best->token != std::nullopt)
                {
                   if (token != std::nullopt && token->size() > m_best->token->size())
                   {
-                     m_best = CompletePattern(index - res.backtrack_cols, token);
+                     m_best = CompletePattern(index + 1 - res.backtrack_cols, token);
                   }
                }
                else
                {
-                  m_best = CompletePattern(index - res.backtrack_cols, token);
+                  m_best = CompletePattern(index + 1 - res.backtrack_cols, token);
                }
                m_done[I] = true;
             }
@@ -250,38 +356,29 @@ namespace alumi
                   if (token != std::nullopt)
                   {
                      tokens.push_back(*token);
-
-                     return LexerResult(LexerResults::Completed, (1 + col_end) - col_start - token->size());
-                  }
-                  else
-                  {
-                     return LexerResult(LexerResults::Completed, index - m_best->end_pos);
                   }
+                  // Steps back to the end of the best match, counted in code points from
+                  // after the current one
+                  finished = LexerResult(LexerResults::Completed, index + 1 - m_best->end_pos);
+                  return true;
                }
-               return LexerResult(LexerResults::Failed, 0);
-
+               finished = LexerResult(LexerResults::Failed, 0);
+               return true;
             }
          }
-         return handle_codepoint<I + 1>(cp, token_start_index, index, tokens, line, col_start, col_end);
-      }
-
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if<I == sizeof...(PatternTs), LexerResult>::type
-         terminate_codepoint(size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t col_start, size_t col_end)
-      {
-         return LexerResult(LexerResults::Failed, 0);
+         return false;
       }
 
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if < I < sizeof...(PatternTs), LexerResult>::type
-         terminate_codepoint(size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t col_start, size_t col_end)
+      template<std::size_t I>
+      bool terminate_pattern(std::u8string_view text, size_t token_start_index, size_t index, Tokens& tokens, size_t line, size_t line_start, size_t end_pos, LexerResult& finished)
       {
          if (!m_done[I])
          {
             auto res = std::get<I>(m_pattern).terminate(index);
             if (res.type == LexerResults::Completed)
             {
-               auto token = make_token(std::get<I>(m_pattern), line, col_start, (col_end - res.backtrack_cols), token_start_index);
+               size_t token_end = retreat(text, end_pos, res.backtrack_cols);
+               auto token = make_token(std::get<I>(m_pattern), line, token_start_index - line_start, token_end - line_start, token_start_index);
                if (m_best != std::nullopt && m_best->token != std::nullopt)
                {
                   if (token != std::nullopt && token->size() > m_best->token->size())
@@ -307,19 +404,15 @@ namespace alumi
                   if (token != std::nullopt)
                   {
                      tokens.push_back(*token);
-
-                     return LexerResult(LexerResults::Completed, (col_end) - col_start - token->size());
-                  }
-                  else
-                  {
-                     return LexerResult(LexerResults::Completed, index - m_best->end_pos);
                   }
+                  finished = LexerResult(LexerResults::Completed, index - m_best->end_pos);
+                  return true;
                }
-               return LexerResult(LexerResults::Failed, 0);
-
+               finished = LexerResult(LexerResults::Failed, 0);
+               return true;
             }
          }
-         return terminate_codepoint<I + 1>(token_start_index, index, tokens, line, col_start, col_end);
+         return false;
       }
 
       bool all_done() const
@@ -1,24 +1,64 @@
 #pragma once
 
 #include "alumi/lexer/token.h"
+#include "alumi/lexer/literal_table.h"
+#include "alumi/lexer/symbol_table.h"
 #include "alumi/parser/data.h"
 
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace alumi
 {
+   //!
+   //! The tokens of a LexedText split into an array per field, so that scanning one field does not load
+   //! the others. Offsets are byte offsets into the text, as with TextPos::byte_index
+   //! 
+   struct TokenColumns
+   {
+      std::span<const TokenType> types;
+      std::span<const uint32_t> offsets;
+      std::span<const uint32_t> sizes;
+      //! SymbolTable::NO_SYMBOL for tokens that are not symbols
+      std::span<const SymbolId> symbol_ids;
+   };
+
    //!
    //! Represents a set of text after being lexed, containing the tokens and the 
-   //! code points
+   //! UTF-8 source, as well as the values of the literal tokens and the
+   //! interned spellings of the symbol tokens
    //! 
    class LexedText
    {
    public:
-      LexedText(const std::vector<UnicodeCodePoint>& text, const Tokens& tokens);
+      LexedText(std::u8string text, const Tokens& tokens, LiteralTable literals = LiteralTable(), SymbolTable symbols = SymbolTable());
 
-      const std::vector<UnicodeCodePoint>& text() const;
+      std::u8string_view text() const;
 
       const Tokens& tokens() const;
+
+      //! The same tokens as tokens(), one array per field
+      TokenColumns columns() const;
+
+      //! The source text covered by a token
+      std::u8string_view token_text(const Token& token) const;
+      std::u8string_view token_text(size_t token_index) const;
+
+      //! Values of the Literal tokens, indexed by token index
+      const LiteralTable& literals() const;
+
+      //! Interned spellings of the Symbol tokens, indexed by token index
+      const SymbolTable& symbols() const;
    private:
-      std::vector<UnicodeCodePoint> m_text;
+      std::u8string m_text;
       Tokens m_tokens;
+      std::vector<TokenType> m_types;
+      std::vector<uint32_t> m_offsets;
+      std::vector<uint32_t> m_sizes;
+      LiteralTable m_literals;
+      SymbolTable m_symbols;
    };
 }
@@ -9,6 +9,7 @@
 #include <concepts>
 #include <limits>
 #include <unordered_set>
+#include <utility>
 
 namespace alumi
 {
@@ -154,7 +155,7 @@ namespace alumi
             m_pattern_index = 0;
             m_offset = 0;
          }
-         auto res = process_pattern<0>(cp, index - m_offset);
+         auto res = dispatch_check(cp, index - m_offset, std::index_sequence_for<PatternT...>());
          if (res.type == LexerResults::Completed)
          {
             m_pattern_index += 1;
@@ -173,44 +174,25 @@ namespace alumi
 
       LexerResult terminate(size_t index)
       {
-         return terminate_pattern<0>(index - m_offset);
+         return dispatch_terminate(index - m_offset, std::index_sequence_for<PatternT...>());
       }
 
    private:
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type
-         process_pattern(UnicodeCodePoint cp, size_t index)
-      { 
-         return LexerResult(LexerResults::Failed, 0);
-      }
-
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if < I < sizeof...(PatternT), LexerResult>::type
-         process_pattern(UnicodeCodePoint cp, size_t index)
-      {
-         if (m_pattern_index == I)
-         {
-            return std::get<I>(m_pattern).check(cp, index);
-         }
-         return process_pattern<I + 1>(cp, index);
-      }
-
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type
-         terminate_pattern(size_t index)
+      //! Checks only the current element, the fold stops at the first index that matches m_pattern_index
+      template<std::size_t... Is>
+      LexerResult dispatch_check(UnicodeCodePoint cp, size_t index, std::index_sequence<Is...>)
       {
-         return LexerResult(LexerResults::Failed, 0);
+         LexerResult res(LexerResults::Failed, 0);
+         ((m_pattern_index == Is ? (res = std::get<Is>(m_pattern).check(cp, index), true) : false) || ...);
+         return res;
       }
 
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if < I < sizeof...(PatternT), LexerResult>::type
-         terminate_pattern(size_t index)
+      template<std::size_t... Is>
+      LexerResult dispatch_terminate(size_t index, std::index_sequence<Is...>)
       {
-         if (m_pattern_index == I)
-         {
-            return std::get<I>(m_pattern).terminate(index);
-         }
-         return terminate_pattern<I + 1>(index);
+         LexerResult res(LexerResults::Failed, 0);
+         ((m_pattern_index == Is ? (res = std::get<Is>(m_pattern).terminate(index), true) : false) || ...);
+         return res;
       }
 
       std::tuple<PatternT...> m_pattern;
@@ -240,7 +222,7 @@ namespace alumi
                m_failed[i] = false;
             }
          }
-         auto res = process_pattern<0>(cp, index);
+         auto res = process_patterns(cp, index, std::index_sequence_for<PatternT...>());
          if (res.type == LexerResults::Continue)
          {
             for (size_t i = 0; i < sizeof...(PatternT); ++i)
@@ -260,60 +242,64 @@ namespace alumi
 
       LexerResult terminate(size_t index)
       {
-         return terminate_pattern<0>(index);
+         return terminate_patterns(index, std::index_sequence_for<PatternT...>());
       }
 
    private:
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type
-         process_pattern(UnicodeCodePoint cp, size_t index)
+      //! Checks every pattern that has not failed yet, in order, stopping at the first one to complete
+      template<std::size_t... Is>
+      LexerResult process_patterns(UnicodeCodePoint cp, size_t index, std::index_sequence<Is...>)
       {
-         return LexerResult(LexerResults::Continue, 0);
+         LexerResult res(LexerResults::Continue, 0);
+         (process_pattern<Is>(cp, index, res) || ...);
+         return res;
       }
 
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if < I < sizeof...(PatternT), LexerResult>::type
-         process_pattern(UnicodeCodePoint cp, size_t index)
+      template<std::size_t... Is>
+      LexerResult terminate_patterns(size_t index, std::index_sequence<Is...>)
+      {
+         LexerResult res(LexerResults::Failed, 0);
+         (terminate_pattern<Is>(index, res) || ...);
+         return res;
+      }
+
+      //! @returns true if pattern I completed, in which case its result is written to completed
+      template<std::size_t I>
+      bool process_pattern(UnicodeCodePoint cp, size_t index, LexerResult& completed)
       {
          if (!m_failed[I])
          {
             auto res = std::get<I>(m_pattern).check(cp, index);
             if (res.type == LexerResults::Completed)
             {
-               return res;
+               completed = res;
+               return true;
             }
             else if (res.type == LexerResults::Failed)
             {
                m_failed[I] = true;
             }
          }
-         return process_pattern<I + 1>(cp, index);
-      }
-
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if<I == sizeof...(PatternT), LexerResult>::type
-         terminate_pattern(size_t index)
-      {
-         return LexerResult(LexerResults::Failed, 0);
+         return false;
       }
 
-      template<std::size_t I = 0, typename... Tp>
-      inline typename std::enable_if < I < sizeof...(PatternT), LexerResult>::type
-         terminate_pattern(size_t index)
+      template<std::size_t I>
+      bool terminate_pattern(size_t index, LexerResult& completed)
       {
          if (!m_failed[I])
          {
             auto res = std::get<I>(m_pattern).terminate(index);
             if (res.type == LexerResults::Completed)
             {
-               return res;
+               completed = res;
+               return true;
             }
             else if (res.type == LexerResults::Failed)
             {
                m_failed[I] = true;
             }
          }
-         return terminate_pattern<I + 1>(index);
+         return false;
       }
 
       std::tuple<PatternT...> m_pattern;
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "alumi/parser/data.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace alumi
+{
+   //!
+   //! The value of a numeric literal, parsed once while lexing
+   //! 
+   //! Integers that do not fit in 64 bits are kept as the nearest double,
+   //! and floats outside the range of a double as infinity or zero. Either
+   //! way the value is flagged as overflowed, so the diagnostic only has to
+   //! be raised once
+   //!
+   class LiteralValue
+   {
+   public:
+      enum class Kind : uint8_t
+      {
+         Integer,
+         Float
+      };
+
+      static LiteralValue integer(int64_t value);
+      static LiteralValue floating(double value, bool overflowed = false);
+
+      Kind kind() const;
+
+      int64_t as_integer() const;
+      double as_float() const;
+
+      //! True if the literal was written as an integer too large for 64 bits,
+      //! or as a float too large or too small for a double
+      bool overflowed() const;
+
+      bool operator==(const LiteralValue& r) const;
+   private:
+      LiteralValue(Kind kind, bool overflowed);
+
+      union
+      {
+         int64_t m_integer;
+         double m_float;
+      };
+      Kind m_kind;
+      bool m_overflowed;
+   };
+
+   //!
+   //! Parses the UTF-8 text of a numeric literal, returns nullopt if it does
+   //! not form a number
+   //! 
+   std::optional<LiteralValue> parse_literal(std::u8string_view text);
+
+   //!
+   //! Side table of literal values indexed by the index of their token, only
+   //! literal tokens take up space
+   //! 
+   class LiteralTable
+   {
+   public:
+      //! Token indices must be added in increasing order
+      void add(size_t token_index, const LiteralValue& value);
+
+      std::optional<LiteralValue> find(size_t token_index) const;
+
+      size_t size() const;
+
+      //! Number of literals that overflowed while parsing
+      size_t overflow_count() const;
+   private:
+      std::vector<uint32_t> m_token_indices;
+      std::vector<LiteralValue> m_values;
+      size_t m_overflow_count = 0;
+   };
+}
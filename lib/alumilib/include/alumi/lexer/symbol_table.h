@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace alumi
+{
+   //! Dense id of an interned spelling, handed out from 0 in order of first appearance
+   using SymbolId = uint32_t;
+
+   //!
+   //! Side table of the spellings of Symbol tokens, interned while lexing
+   //! 
+   //! Each distinct spelling is stored once and known by a SymbolId, so equal
+   //! names compare as equal integers. The id of each token is kept in a column
+   //! indexed by token index, NO_SYMBOL for tokens that are not symbols
+   //!
+   class SymbolTable
+   {
+   public:
+      static constexpr SymbolId NO_SYMBOL = std::numeric_limits<SymbolId>::max();
+
+      SymbolTable() = default;
+      SymbolTable(const SymbolTable& other);
+      SymbolTable(SymbolTable&& other) = default;
+
+      SymbolTable& operator=(const SymbolTable& other);
+      SymbolTable& operator=(SymbolTable&& other) = default;
+
+      //! Interns the spelling of the token, token indices must be added in increasing order
+      SymbolId add(size_t token_index, std::u8string_view spelling);
+
+      //! Marks the tokens past the last symbol, up to token_count, as not being symbols
+      void cover(size_t token_count);
+
+      //! The id of the symbol token at the index
+      std::optional<SymbolId> find(size_t token_index) const;
+
+      //! The id of every token added or covered so far, NO_SYMBOL if it is not a symbol
+      std::span<const SymbolId> ids() const;
+
+      //! The id of a spelling, if any symbol token had it
+      std::optional<SymbolId> find_spelling(std::u8string_view spelling) const;
+
+      std::u8string_view spelling(SymbolId id) const;
+
+      //! Number of distinct spellings
+      size_t size() const;
+   private:
+      void reindex();
+
+      // Indexed by token index
+      std::vector<SymbolId> m_ids;
+      // Views into the deque stay valid as it grows, so they can key the index
+      std::deque<std::u8string> m_spellings;
+      std::unordered_map<std::u8string_view, SymbolId> m_index;
+   };
+}
@@ -2,12 +2,14 @@
 
 #include "alumi/text_pos.h"
 
+#include <cstdint>
 #include <vector>
 
 namespace alumi
 {
 
-   enum class TokenType
+   //! A single byte, so that the types of a token stream can be kept packed next to it
+   enum class TokenType : uint8_t
    {
       Operator         = 0,
       Assignment       = 1,
@@ -29,6 +31,62 @@ namespace alumi
       EndOfFile        = 17
    };
 
+   //!
+   //! A set of token types, stored as a bitmask
+   //! 
+   class TokenTypeSet
+   {
+   public:
+      constexpr TokenTypeSet() = default;
+
+      constexpr TokenTypeSet(TokenType type)
+         : m_bits(bit(type))
+      {
+      }
+
+      //! Every token type
+      static constexpr TokenTypeSet all()
+      {
+         TokenTypeSet set;
+         set.m_bits = (bit(TokenType::EndOfFile) << 1) - 1;
+         return set;
+      }
+
+      constexpr void insert(TokenType type)
+      {
+         m_bits |= bit(type);
+      }
+
+      constexpr bool contains(TokenType type) const
+      {
+         return (m_bits & bit(type)) != 0;
+      }
+
+      constexpr bool empty() const
+      {
+         return m_bits == 0;
+      }
+
+      constexpr TokenTypeSet operator|(const TokenTypeSet& r) const
+      {
+         TokenTypeSet set;
+         set.m_bits = m_bits | r.m_bits;
+         return set;
+      }
+
+      constexpr bool operator==(const TokenTypeSet& r) const = default;
+
+   private:
+      static constexpr uint32_t bit(TokenType type)
+      {
+         return uint32_t(1) << static_cast<uint32_t>(type);
+      }
+
+      static_assert(static_cast<uint32_t>(TokenType::EndOfFile) < 32, "TokenTypeSet must fit every token type");
+
+      uint32_t m_bits = 0;
+   };
+
 
    class Token
    {
@@ -36,6 +94,7 @@ namespace alumi
       Token(TokenType type, TextPos pos, size_t size);
 
       TextPos pos() const;
+      //! Size in bytes of the UTF-8 text the token covers
       size_t size() const;
       TokenType type() const;
 
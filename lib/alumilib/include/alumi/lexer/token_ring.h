@@ -0,0 +1,53 @@
+#pragma once
+
+#include "alumi/lexer/token.h"
+
+#include <atomic>
+#include <cstddef>
+#include <span>
+
+namespace alumi
+{
+   //!
+   //! Bounded queue handing tokens from a lexing thread to a parsing thread, without locks
+   //!
+   //! There must be exactly one thread pushing and one thread popping. Either side waits on the
+   //! other's index only when the ring is full or empty
+   //!
+   class TokenRing
+   {
+   public:
+      static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+      explicit TokenRing(size_t capacity = DEFAULT_CAPACITY);
+
+      TokenRing(const TokenRing&) = delete;
+      TokenRing& operator=(const TokenRing&) = delete;
+
+      //!
+      //! Appends tokens, waiting for the consumer whenever the ring is full. Producer only
+      //!
+      void push(std::span<const Token> tokens);
+
+      //!
+      //! Marks that no more tokens will be pushed. Producer only
+      //!
+      void close();
+
+      //!
+      //! Moves every token pushed so far onto the end of out, waiting if there are none yet. Consumer only
+      //! @returns false once the ring is closed and every token was taken
+      //!
+      bool pop_available(Tokens& out);
+
+   private:
+      // Set in m_tail once the ring is closed
+      static constexpr size_t CLOSED = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+      Tokens m_slots;
+      // Count of tokens taken, written only by the consumer
+      alignas(64) std::atomic<size_t> m_head;
+      // Count of tokens pushed, written only by the producer
+      alignas(64) std::atomic<size_t> m_tail;
+   };
+}
@@ -1,23 +1,120 @@
 #pragma once
 
+#include <future>
 #include <memory>
+#include <optional>
+#include <span>
 
 #include "alumi/lexer.h"
+#include "alumi/lexer/token_ring.h"
 #include "alumi/syntax_tree.h"
 
+import alumi.parser.context;
+
 namespace alumi
 {
    namespace parser
    {
+      //!
+      //! An edit of a token stream, where the tokens from start up to old_end were replaced by the tokens from start up to new_end
+      //! 
+      struct TokenEdit
+      {
+         size_t start;
+         size_t old_end;
+         size_t new_end;
+      };
+
+      //!
+      //! A tree together with the text it was parsed from, for parses that lex the text as well
+      //! 
+      struct ParsedText
+      {
+         std::unique_ptr<LexedText> text;
+         SyntaxTree tree;
+      };
+
       class AlumiParser
       {
       public:
-         AlumiParser();
+         AlumiParser(ParseOptions options = ParseOptions());
          ~AlumiParser();
 
          SyntaxTree parse(const LexedText& text) const;
 
+         //!
+         //! Lexes source on a separate thread while parsing it, the lexer hands its tokens over through a TokenRing
+         //! each time a line starts at column zero. Top level statements are parsed as soon as the statement after
+         //! them is lexed, as far as they can be parsed on their own, the rest is parsed once lexing is done
+         //! 
+         //! Throws the LexerFailure of the lexer, if any
+         //! @param lexer          a Lexer, used only by the lexing thread until this returns
+         //! @param source         the UTF-8 text to parse
+         //! @param ring_capacity  how many tokens the lexer may be ahead of the parser before it waits
+         //! 
+         template<typename LexerT>
+         ParsedText parse_pipelined(LexerT& lexer, std::u8string_view source, size_t ring_capacity = TokenRing::DEFAULT_CAPACITY) const
+         {
+            TokenRing ring(ring_capacity);
+            auto lexed = std::async(std::launch::async, [&]()
+               {
+                  // Closes the ring however lexing ends, so the parser never waits on it forever
+                  struct RingCloser
+                  {
+                     TokenRing& ring;
+                     ~RingCloser() { ring.close(); }
+                  } closer{ ring };
+
+                  size_t published = 0;
+                  return lexer.lex(source, [&](const Tokens& tokens)
+                     {
+                        ring.push(std::span<const Token>(tokens).subspan(published));
+                        published = tokens.size();
+                     });
+               });
+            return parse_from_ring(ring, source, lexed);
+         }
+
+         //!
+         //! Parses a DeferredBlock node, left in the place of a block when parsing with ParseOptions::defer_blocks
+         //! @param text      the text the node was parsed from
+         //! @param deferred  a DeferredBlock node
+         //! 
+         SyntaxTree parse_deferred(const LexedText& text, const Node& deferred) const;
+
+         //!
+         //! Parses text after an edit, reusing the top level statements of the previous tree that are clear of the edit.
+         //! Falls back to a full parse if the previous tree had errors, or if the reparsed statements do not line up
+         //! @param previous  the tree parsed from the text before the edit
+         //! @param text      the text after the edit
+         //! @param edit      the tokens that changed
+         //! 
+         SyntaxTree reparse(const SyntaxTree& previous, const LexedText& text, const TokenEdit& edit) const;
+
       private:
+         //!
+         //! Parses the top level statements of the module on separate threads, or returns nullopt if the
+         //! module cannot be split or has errors, leaving it to be parsed sequentially
+         //! 
+         std::optional<SyntaxTree> parse_parallel(const LexedText& text) const;
+
+         //!
+         //! Parses the module with its function bodies deferred, then parses each body from a work list
+         //! and splices it in place of its DeferredBlock node, for ParseOptions::iterative
+         //! 
+         SyntaxTree parse_iterative(const LexedText& text) const;
+
+         //!
+         //! Parses a DeferredBlock node in the given context, which may already hold the nodes of other bodies
+         //! 
+         SyntaxTree parse_deferred(const LexedText& text, const Node& deferred, std::shared_ptr<ParseContext> context) const;
+
+         //!
+         //! The parsing side of parse_pipelined, takes every token from the ring and then the lexed text
+         //! 
+         ParsedText parse_from_ring(TokenRing& ring, std::u8string_view source, std::future<LexedText>& lexed) const;
+
+         ParseOptions m_options;
       };
    }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
 
 namespace alumi
@@ -8,4 +9,6 @@ namespace alumi
    using UnicodeCodePoint = uint32_t;
 
    std::string as_utf8(UnicodeCodePoint cp);
+
+   std::u8string to_utf8(std::span<const UnicodeCodePoint> code_points);
 }
@@ -4,4 +4,6 @@ import alumi.parser.result;
 import alumi.parser.combinator;
 
 
-#define RULE(name, ...) class name; class name  { public: using RuleOp = __VA_ARGS__;  static Result parse(Subparser& parent){ return RuleOp::parse(parent); }; }
+//! first_set is a template so it is only evaluated where it is used, by then rules that were forward declared are complete.
+//! Parsing goes through trace_rule, which records the rule by name when compiled with ALUMI_PARSER_TRACING
+#define RULE(name, ...) class name; class name  { public: using RuleOp = __VA_ARGS__;  static Result parse(Subparser& parent){ return trace_rule(#name, parent, [&]() { return RuleOp::parse(parent); }); }; template<typename Self = name> static constexpr FirstSet first_set() { return first_set_of<typename Self::RuleOp>(); } }
@@ -2,7 +2,10 @@
 
 #include "alumi/lexer/lexed_text.h"
 
+#include <memory>
+
 import alumi.syntax_tree.nodes;
+import alumi.parser.context;
 import alumi.parser.result;
 
 namespace alumi
@@ -15,13 +18,17 @@ namespace alumi
    class SyntaxTree
    {
    public:
-      SyntaxTree(const Result& result, const LexedText* source);
+      //! @param context  the context of the parse, for the tree to keep alive along with the result. Null if the caller keeps it
+      SyntaxTree(const Result& result, const LexedText* source, std::shared_ptr<ParseContext> context = nullptr);
 
       Nodes& nodes();
       const Nodes& nodes() const;
 
       const Result& parse_result() const;
       const LexedText& source() const;
+
+      //! The context the tree was parsed in, if the tree owns it
+      const std::shared_ptr<ParseContext>& context() const;
    
       //!
       //! Gets the direct token indices that a single node is built of. Note that the result may be empty
@@ -30,6 +37,7 @@ namespace alumi
       std::vector<size_t> direct_tokens(const Result* node) const;
 
    private:
+      std::shared_ptr<ParseContext> m_context;
       Result m_result;
 
       Nodes m_current_nodes;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 
 namespace alumi::syntax_tree
 {
@@ -19,6 +20,11 @@ namespace alumi::syntax_tree
 		size_t get_skips() const;
 		size_t get_count() const;
 
+		//! Adds nodes to the end of the group
+		void grow(std::ptrdiff_t nodes);
+		//! Moves the start of the group by nodes, for when a group before it grew
+		void move(std::ptrdiff_t nodes);
+
 	private:
 		size_t m_skips;
 		size_t m_count;
@@ -59,6 +65,23 @@ namespace alumi::syntax_tree
 			return m_groups.size();
 		}
 
+		//!
+		//! Grows the group holding the node offset nodes after the parent by nodes, moving the groups after it along
+		//! 
+		void grow_group_at(size_t offset, std::ptrdiff_t nodes)
+		{
+			size_t index = 0;
+			while (index + 1 < Groups && offset >= m_groups[index].get_skips() + m_groups[index].get_count())
+			{
+				++index;
+			}
+			m_groups[index].grow(nodes);
+			for (++index; index < Groups; ++index)
+			{
+				m_groups[index].move(nodes);
+			}
+		}
+
 	private:
 		std::array<ChildGroup, Groups> m_groups;
 	};
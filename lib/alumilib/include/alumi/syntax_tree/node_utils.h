@@ -3,6 +3,9 @@
 #include "alumi/parser/data.h"
 #include "alumi/syntax_tree.h"
 
+#include <string>
+#include <string_view>
+
 import alumi.parser;
 
 namespace alumi
@@ -26,8 +29,12 @@ namespace alumi
 		//! Converts a single node to the source text, replaces "in-the-middle" child nodes with " ... ". 
 		//! May be empty if it did not consume any tokens by itself
 		//! 
-		std::vector<UnicodeCodePoint> as_string(const Node& node, const SyntaxTree& tree);
-		//! Converts a single node to the source text it consumed
-		std::vector<UnicodeCodePoint> as_string_deep(const Node& node, const SyntaxTree& tree);
+		std::u8string as_string(const Node& node, const SyntaxTree& tree);
+		//!
+		//! The source text a node and its children consumed, from the start of its first token through
+		//! the end of its last one, so a statement includes its line break. Line breaks are kept as they
+		//! are rather than escaped. A view into the tree's source, empty if the node spans no tokens
+		//! 
+		std::u8string_view as_string_deep(const Node& node, const SyntaxTree& tree);
 	}
 }
\ No newline at end of file
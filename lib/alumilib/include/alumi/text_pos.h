@@ -5,23 +5,27 @@
 
 namespace alumi
 {
+   //!
+   //! Position in UTF-8 source text, the column counts bytes from the start
+   //! of the line and the byte index bytes from the start of the text
+   //! 
    class TextPos
    {
    public:
-      TextPos(size_t line, size_t col, size_t char_index);
+      TextPos(size_t line, size_t col, size_t byte_index);
 
       size_t line() const;
       
       size_t col() const;
 
-      size_t char_index() const;
+      size_t byte_index() const;
 
       auto operator<=>(const TextPos& other) const = default;
 
    private:
       size_t m_line;
       size_t m_col;
-      size_t m_char_index;
+      size_t m_byte_index;
    };
 
 }
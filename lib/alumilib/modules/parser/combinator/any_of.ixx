@@ -1,67 +1,167 @@
 module;
 
+#include "alumi/lexer/token.h"
+
+#include <array>
+#include <cstdint>
 #include <optional>
+#include <utility>
 
 export module alumi.parser.combinator:any_of;
 
 import :concepts;
+import :stop;
+import :trace;
 
+import alumi.parser.context;
 import alumi.parser.result;
 import alumi.parser.subparser;
 
+using namespace alumi;
+
 export {
 
    //! 
-   //! Expects one of several child-rules. If none of them matches, produces a parse failure on the LONGEST match before failure. In case of a tie, fails on the last subrule of those tied
+   //! Expects one of several child-rules. If none of them matches, produces a parse failure on the LONGEST match before failure. In case of a tie, fails on the first subrule of those tied
+   //! 
+   //! Alternatives whose FirstSet rules out the next token are bound to fail, so they are skipped unless every
+   //! viable alternative fails, in which case they are still tried to find the best failure
    //! @tparam Ts    one or more child rules
    //! 
    template<ParserElement... Ts>
    class AnyOf
    {
    public:
+      static constexpr FirstSet first_set()
+      {
+         return (FirstSet() | ... | first_set_of<Ts>());
+      }
+
       static Result parse(Subparser& parent)
       {
-         std::optional<Result> best_failure;
-         Result res = do_parse<Ts...>(parent, best_failure);
-         if (res.get_type() != Result::Type::Success)
+         static_assert(sizeof...(Ts) <= 32, "AnyOf supports at most 32 alternatives");
+         static constexpr std::array<uint32_t, 32> viable_by_token = build_dispatch_table();
+
+         NodeBuffer& nodes = parent.context().nodes();
+         State state{ nodes.mark() };
+         if (parent.context().is_stopped())
          {
-            res = *best_failure;
+            return stop_parsing(parent, state.node_mark);
          }
-         parent.take_over_from(res.get_subparser());
-         return Result(res.get_type(), parent, res.get_nodes());
 
+         uint32_t viable = viable_by_token[static_cast<size_t>(parent.peek_type())];
+         if (try_alternatives(parent, state, viable, true, std::index_sequence_for<Ts...>()) ||
+             try_alternatives(parent, state, ~viable, false, std::index_sequence_for<Ts...>()))
+         {
+            parent.take_over_from(state.success->get_subparser());
+            return Result(Result::Type::Success, parent, nodes.since(state.node_mark));
+         }
+
+         // Every failed alternative was rolled back, so the nodes of the best one are restored
+         if (!state.stopped)
+         {
+            nodes.append(state.best_failure_nodes);
+         }
+         parent.take_over_from(state.best_failure->get_subparser());
+         return Result(state.best_failure->get_type(), parent, nodes.since(state.node_mark));
       }
    private:
+      class State
+      {
+      public:
+         size_t node_mark;
+         std::optional<Result> success;
+         std::optional<Result> best_failure;
+         size_t best_failure_index = 0;
+         Nodes best_failure_nodes;
+         //! Whether the best failure is a stop, which keeps its nodes in place
+         bool stopped = false;
+      };
 
-      template<ParserElement ElemT>
-      static Result do_parse(Subparser& parent, std::optional<Result>& best_failure)
+      //! For each token type, a bitmask of the alternatives that could start with it
+      static constexpr std::array<uint32_t, 32> build_dispatch_table()
       {
-         Subparser parser = parent.create_child();
-         Result res = ElemT::parse(parser);
-         if (res.get_type() != Result::Type::Success)
+         constexpr std::array<FirstSet, sizeof...(Ts)> first_sets{ first_set_of<Ts>()... };
+
+         std::array<uint32_t, 32> table{};
+         for (uint32_t type = 0; type < table.size(); ++type)
          {
-            if (!best_failure.has_value() ||
-               (res.get_type() > best_failure->get_type()) ||
-               (res.get_type() == best_failure->get_type() && res.get_consumed() > best_failure->get_consumed()))
+            for (size_t i = 0; i < first_sets.size(); ++i)
             {
-               best_failure = res;
+               if (first_sets[i].can_start_with(static_cast<TokenType>(type)))
+               {
+                  table[type] |= uint32_t(1) << i;
+               }
             }
          }
-         return res;
+         return table;
       }
 
-      template<ParserElement ElemT, ParserElement NextT, ParserElement... OthersT>
-      static Result do_parse(Subparser& parent, std::optional<Result>& best_failure)
+      //! Only viable alternatives may succeed, so only while trying those could a later one still win
+      template<size_t... Is>
+      static bool try_alternatives(Subparser& parent, State& state, uint32_t alternatives, bool viable, std::index_sequence<Is...>)
       {
-         Result res = do_parse<ElemT>(parent, best_failure);
-         if (res.get_type() != Result::Type::Success)
+         return (try_alternative<Is, Ts>(parent, state, alternatives, viable) || ...);
+      }
+
+      template<size_t index, ParserElement ElemT>
+      static bool try_alternative(Subparser& parent, State& state, uint32_t alternatives, bool viable)
+      {
+         // Once an alternative fails on a stop, the rest are not tried and its failure is the one passed on
+         if ((alternatives & (uint32_t(1) << index)) == 0 || parent.context().is_stopped())
+         {
+            return false;
+         }
+
+         // Committed to only if nothing else could be taken instead, with no failure before it to fall back to and
+         // no later alternative that could succeed. Those that cannot start here only pick the failure to report
+         bool speculative = !viable || state.best_failure.has_value() || (alternatives >> index >> 1) != 0;
+         if (speculative)
+         {
+            parent.context().begin_speculation();
+         }
+         size_t indent_mark = parent.context().indent_stacks().mark();
+         Subparser parser = parent.create_child();
+         Result res = ElemT::parse(parser);
+         if (speculative)
+         {
+            parent.context().end_speculation();
+         }
+
+         if (res.get_type() == Result::Type::Success)
+         {
+            state.success = res;
+            return true;
+         }
+
+         if (failed_on_stop(res))
+         {
+            // The parse ends with this failure, so its nodes are left where they are instead of being set aside
+            state.best_failure = res;
+            state.best_failure_index = index;
+            state.stopped = true;
+            return false;
+         }
+
+         if (!state.best_failure.has_value() ||
+            (res.get_type() > state.best_failure->get_type()) ||
+            (res.get_type() == state.best_failure->get_type() && res.get_consumed() > state.best_failure->get_consumed()) ||
+            (res.get_type() == state.best_failure->get_type() && res.get_consumed() == state.best_failure->get_consumed() && index < state.best_failure_index))
          {
-            return do_parse<NextT, OthersT...>(parent, best_failure);
+            state.best_failure = res;
+            state.best_failure_index = index;
+            NodeBuffer& nodes = parent.context().nodes();
+            NodeSpan failure_nodes = nodes.view(nodes.compact(res.get_node_range()));
+            state.best_failure_nodes.assign(failure_nodes.begin(), failure_nodes.end());
          }
          else
          {
-            return res;
+            // The parent may still take over from the best failure, so only the indents of others are dropped
+            parent.context().indent_stacks().rollback(indent_mark);
          }
+         parent.context().nodes().rollback(state.node_mark);
+         trace_backtrack(parent, res.get_consumed());
+         return false;
       }
 
    };
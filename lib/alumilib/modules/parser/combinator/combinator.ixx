@@ -9,14 +9,18 @@
 export module alumi.parser.combinator;
 
 export import :any_of;
+export import :deferred;
 export import :is;
 export import :optional;
 export import :peek;
+export import :precedence_expression;
 export import :repeats;
 export import :repeats_with_seperator;
 export import :rule;
 export import :sequence;
+export import :stop;
 export import :swallow;
+export import :trace;
 
 export import :indented;
 export import :dedented;
@@ -1,11 +1,73 @@
+module;
+
+#include "alumi/lexer/token.h"
+
 export module alumi.parser.combinator:concepts;
 
 import alumi.parser.subparser;
 
+using namespace alumi;
+
 export
 {
    template<typename T>
    concept ParserElement = requires (T & element, Subparser& parent) {
       true; //element.parse(parent); // If enabled, forward declared types cannot be used and that makes recurisve rules difficult/impossible. This is thus left to true.
    };
-}
\ No newline at end of file
+
+   //!
+   //! The token types an element can succeed on when it is the next token, nullable if it can succeed
+   //! whatever the next token is (such as by consuming nothing). Recovers if it can recover from an error
+   //! whatever the next token is, as rules that synchronize do
+   //!
+   class FirstSet
+   {
+   public:
+      TokenTypeSet tokens;
+      bool nullable = false;
+      bool recovers = false;
+
+      //! The set of an element that nothing is known about
+      static constexpr FirstSet any()
+      {
+         return FirstSet{ TokenTypeSet::all(), true, true };
+      }
+
+      constexpr bool can_start_with(TokenType type) const
+      {
+         return nullable || tokens.contains(type);
+      }
+
+      //!
+      //! Whether the element is bound to fail outright when the next token is of the type,
+      //! so a combinator that would discard the failure need not parse it at all
+      //!
+      constexpr bool rules_out(TokenType type) const
+      {
+         return !nullable && !recovers && !tokens.contains(type);
+      }
+
+      constexpr FirstSet operator|(const FirstSet& r) const
+      {
+         return FirstSet{ tokens | r.tokens, nullable || r.nullable, recovers || r.recovers };
+      }
+   };
+
+   //!
+   //! The FirstSet of an element, elements that do not declare one through a static first_set() could start with anything
+   //!
+   //! Only evaluate this from within parse functions, where every rule is complete even if it was forward declared
+   //!
+   template<typename T>
+   constexpr FirstSet first_set_of()
+   {
+      if constexpr (requires { T::first_set(); })
+      {
+         return T::first_set();
+      }
+      else
+      {
+         return FirstSet::any();
+      }
+   }
+}
@@ -0,0 +1,82 @@
+module;
+
+#include "alumi/lexer/token.h"
+
+#include <cstdint>
+#include <optional>
+
+export module alumi.parser.combinator:deferred;
+
+import :concepts;
+
+import alumi.parser.context;
+import alumi.parser.result;
+import alumi.parser.subparser;
+import alumi.syntax_tree.nodes;
+
+using namespace alumi;
+
+export {
+
+   //!
+   //! An indented block parsed by T, unless the parse context defers blocks. Then the block is only skimmed
+   //! to the line that dedents out of it, and FuncT builds the node that stands in for it
+   //!
+   //! Errors within a skimmed block are only found once it is parsed
+   //! @tparam T     a rule starting with Indented and ending with a dedent or the end of the file
+   //!
+   template<ParserElement T, std::optional<Node>(*FuncT)(const Result&)>
+   class Deferred
+   {
+   public:
+      static constexpr FirstSet first_set()
+      {
+         return first_set_of<T>();
+      }
+
+      static Result parse(Subparser& parent)
+      {
+         const Token& start = parent.peek();
+         auto indent = parent.get_indent();
+         bool opens_block = start.type() == TokenType::Indent && (!indent.has_value() || start.size() > *indent);
+         if (!parent.context().options().defer_blocks || !opens_block || parent.is_swallowed(TokenType::Indent))
+         {
+            return T::parse(parent);
+         }
+
+         Subparser child = parent.create_child();
+         child.advance_past(block_end(child, start.size()));
+
+         NodeBuffer& nodes = parent.context().nodes();
+         size_t node_mark = nodes.mark();
+         auto node_opt = FuncT(Result(Result::Type::Success, child, {}));
+         if (node_opt.has_value())
+         {
+            nodes.append(NodeSpan(&*node_opt, 1));
+         }
+
+         parent.take_over_from(child);
+         return Result(Result::Type::Success, parent, nodes.since(node_mark));
+      }
+
+   private:
+      //!
+      //! Index of the first indent after the start of the block that is less indented than it,
+      //! or of the end of the file
+      //!
+      static size_t block_end(const Subparser& block, size_t block_indent)
+      {
+         const auto& tokens = block.tokens();
+         auto indents = block.context().token_index().indents_between(block.token_types(), block.current_token_index() + 1, tokens.size());
+         for (uint32_t index : indents)
+         {
+            if (tokens[index].size() < block_indent)
+            {
+               return index;
+            }
+         }
+         return tokens.size() - 1;
+      }
+   };
+
+}
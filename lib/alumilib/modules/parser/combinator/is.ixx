@@ -17,9 +17,16 @@ export {
    class Is
    {
    public:
+      static constexpr FirstSet first_set()
+      {
+         return FirstSet{ token_type };
+      }
+
       static Result parse(Subparser& parent)
       {
-         if (parent.advance().type() == token_type)
+         TokenType type = parent.peek_type();
+         parent.advance();
+         if (type == token_type)
          {
             return Result(Result::Type::Success, parent, {});
          }
@@ -18,10 +18,15 @@ export {
    class NoIndent
    {
    public:
+      static constexpr FirstSet first_set()
+      {
+         return FirstSet{ TokenType::Indent };
+      }
+
       static Result parse(Subparser& parent)
       {
          auto indent = parent.get_indent();
-         auto token = parent.advance();
+         const Token& token = parent.advance();
 
          if (token.type() == TokenType::Indent)
          {
@@ -1,7 +1,10 @@
 export module alumi.parser.combinator:optional;
 
 import :concepts;
+import :stop;
+import :trace;
 
+import alumi.parser.context;
 import alumi.parser.result;
 import alumi.parser.subparser;
 
@@ -11,18 +14,43 @@ export {
    class Optional
    {
    public:
+      static constexpr FirstSet first_set()
+      {
+         return FirstSet{ first_set_of<T>().tokens, true, first_set_of<T>().recovers };
+      }
+
+      //! Does not try T where it is bound to fail
       static Result parse(Subparser& parent)
       {
+         constexpr FirstSet first = first_set_of<T>();
+         if (first.rules_out(parent.peek_type()))
+         {
+            return Result(Result::Type::Success, parent, {});
+         }
+
+         NodeBuffer& nodes = parent.context().nodes();
+         size_t node_mark = nodes.mark();
+         size_t indent_mark = parent.context().indent_stacks().mark();
          Subparser parser = parent.create_child();
+         parent.context().begin_speculation();
          auto res = T::parse(parser);
-         if (res.get_type() == Result::Type::Failure)
+         parent.context().end_speculation();
+         if (failed_on_stop(res))
+         {
+            parent.take_over_from(res.get_subparser());
+            return Result(Result::Type::Failure, parent, nodes.since(node_mark));
+         }
+         else if (res.get_type() == Result::Type::Failure)
          {
+            nodes.rollback(node_mark);
+            parent.context().indent_stacks().rollback(indent_mark);
+            trace_backtrack(parent, res.get_consumed());
             return Result(Result::Type::Success, parent, {});
          }
          else
          {
             parent.take_over_from(res.get_subparser());
-            return Result(Result::Type::Success, parent, res.get_nodes());
+            return Result(Result::Type::Success, parent, nodes.since(node_mark));
          }
       }
 
@@ -1,7 +1,9 @@
 export module alumi.parser.combinator:peek;
 
 import :concepts;
+import :stop;
 
+import alumi.parser.context;
 import alumi.parser.result;
 import alumi.parser.subparser;
 
@@ -11,10 +13,28 @@ export {
    class Peek
    {
    public:
+      //! Consumes nothing, but only succeeds where T would. Where T recovers it fails instead
+      static constexpr FirstSet first_set()
+      {
+         return FirstSet{ first_set_of<T>().tokens, first_set_of<T>().nullable };
+      }
+
       static Result parse(Subparser& parent)
       {
+         NodeBuffer& nodes = parent.context().nodes();
+         size_t node_mark = nodes.mark();
+         size_t indent_mark = parent.context().indent_stacks().mark();
          Subparser child = parent.create_child();
+         parent.context().begin_speculation();
          auto res = T::parse(child);
+         parent.context().end_speculation();
+         if (failed_on_stop(res))
+         {
+            parent.take_over_from(res.get_subparser());
+            return Result(Result::Type::Failure, parent, nodes.since(node_mark));
+         }
+         nodes.rollback(node_mark);
+         parent.context().indent_stacks().rollback(indent_mark);
          if (res.get_type() == Result::Type::Success)
          {
             return Result(Result::Type::Success, parent, {});
@@ -0,0 +1,283 @@
+module;
+
+#include "alumi/lexer/token.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+export module alumi.parser.combinator:precedence_expression;
+
+import :concepts;
+
+import alumi.parser.context;
+import alumi.parser.result;
+import alumi.parser.subparser;
+import alumi.syntax_tree.nodes;
+
+using namespace alumi;
+
+export {
+
+   enum class Fixity
+   {
+      Prefix,
+      Infix,
+      Postfix
+   };
+
+   enum class Associativity
+   {
+      Left,
+      Right
+   };
+
+   //!
+   //! An operator of a PrecedenceExpression, matched on the spelling of Operator tokens.
+   //! Operators with a higher precedence bind tighter
+   //!
+   struct OperatorDefinition
+   {
+      std::u8string_view spelling;
+      Fixity fixity;
+      uint8_t precedence;
+      Associativity associativity = Associativity::Left;
+   };
+
+   //!
+   //! Operands of type T joined by the operators of a table, parsed by precedence climbing in a single loop
+   //! with explicit stacks, so long operator chains neither backtrack nor recurse
+   //!
+   //! An operator is applied by a UnaryOperation or BinaryOperation node, spanning its operands. The expression
+   //! ends at the first token that is not an operator of the table that fits where it is, an Operator token the
+   //! table does not know is left for the rules after
+   //! @tparam T           an operand
+   //! @tparam operators   a constexpr array of OperatorDefinition
+   //!
+   template<ParserElement T, const auto& operators>
+   class PrecedenceExpression
+   {
+   public:
+      static constexpr FirstSet first_set()
+      {
+         FirstSet operand = first_set_of<T>();
+         for (const OperatorDefinition& op : operators)
+         {
+            if (op.fixity == Fixity::Prefix)
+            {
+               operand.tokens.insert(TokenType::Operator);
+            }
+         }
+         return operand;
+      }
+
+      static Result parse(Subparser& parent)
+      {
+         NodeBuffer& nodes = parent.context().nodes();
+         State state{ nodes.mark() };
+
+         bool expect_operand = true;
+         while (true)
+         {
+            const Token& token = parent.peek();
+            if (expect_operand)
+            {
+               if (const OperatorDefinition* op = find_operator(parent, token, Fixity::Prefix))
+               {
+                  parent.advance();
+                  state.pending.push_back(Pending{ op, parent.current_token_index() - 1 });
+                  continue;
+               }
+
+               size_t operand_start = parent.current_token_index();
+               size_t node_start = nodes.mark();
+               Result res = T::parse(parent);
+               if (res.get_type() == Result::Type::Failure)
+               {
+                  return Result(Result::Type::Failure, parent, nodes.since(state.node_mark));
+               }
+               state.worst_result = std::min(state.worst_result, res.get_type());
+               // The operand nodes are moved around by index, so the slots removed among them are dropped now
+               nodes.compact(nodes.since(node_start));
+               state.output.push_back(Item{ nullptr, operand_start, parent.current_token_index(), node_start, nodes.mark() });
+               expect_operand = false;
+            }
+            else if (const OperatorDefinition* op = find_operator(parent, token, Fixity::Postfix))
+            {
+               // Applies right away to the operand before it, after any prefix operators binding tighter
+               apply_pending(state, op->precedence, Associativity::Left);
+               parent.advance();
+               size_t token_index = parent.current_token_index() - 1;
+               state.output.push_back(Item{ op, token_index, token_index + 1, 0, 0 });
+            }
+            else if (const OperatorDefinition* op = find_operator(parent, token, Fixity::Infix))
+            {
+               apply_pending(state, op->precedence, op->associativity);
+               parent.advance();
+               state.pending.push_back(Pending{ op, parent.current_token_index() - 1 });
+               expect_operand = true;
+            }
+            else
+            {
+               break;
+            }
+         }
+         // The operators still pending apply to everything before them, innermost first
+         for (auto ite = state.pending.rbegin(); ite != state.pending.rend(); ++ite)
+         {
+            state.output.push_back(Item{ ite->op, ite->token_index, ite->token_index + 1, 0, 0 });
+         }
+
+         if (state.output.size() > 1)
+         {
+            build_nodes(nodes, state);
+         }
+         return Result(state.worst_result, parent, nodes.since(state.node_mark));
+      }
+
+   private:
+      //! An operator that is waiting for its right hand operand
+      struct Pending
+      {
+         const OperatorDefinition* op;
+         size_t token_index;
+      };
+
+      //! An operand, or an operator that applies to the items before it
+      struct Item
+      {
+         // Null for operands
+         const OperatorDefinition* op;
+         size_t token_start;
+         size_t token_end;
+         // The nodes of an operand
+         size_t node_begin;
+         size_t node_end;
+      };
+
+      struct State
+      {
+         size_t node_mark;
+         Result::Type worst_result = Result::Type::Success;
+         std::vector<Pending> pending;
+         // The operands and operators in postfix order
+         std::vector<Item> output;
+      };
+
+      static const OperatorDefinition* find_operator(const Subparser& parser, const Token& token, Fixity fixity)
+      {
+         if (token.type() != TokenType::Operator)
+         {
+            return nullptr;
+         }
+
+         std::u8string_view spelling = parser.context().token_text(token);
+         for (const OperatorDefinition& op : operators)
+         {
+            if (op.fixity == fixity && op.spelling == spelling)
+            {
+               return &op;
+            }
+         }
+         return nullptr;
+      }
+
+      //!
+      //! Moves the pending operators that bind at least as tight as an operator of the precedence to the output,
+      //! those of the same precedence only if it is left associative
+      //!
+      static void apply_pending(State& state, uint8_t precedence, Associativity associativity)
+      {
+         while (!state.pending.empty())
+         {
+            const Pending& top = state.pending.back();
+            bool binds_tighter = top.op->precedence > precedence ||
+               (top.op->precedence == precedence && associativity == Associativity::Left);
+            if (!binds_tighter)
+            {
+               return;
+            }
+            state.output.push_back(Item{ top.op, top.token_index, top.token_index + 1, 0, 0 });
+            state.pending.pop_back();
+         }
+      }
+
+      //!
+      //! Replaces the operand nodes with the tree of the output, where each operator node precedes its operands
+      //!
+      static void build_nodes(NodeBuffer& nodes, const State& state)
+      {
+         struct Subtree
+         {
+            size_t node_count;
+            size_t token_start;
+            size_t token_end;
+            size_t lhs;
+            size_t rhs;
+         };
+
+         // Resolves the operands of each operator in postfix order
+         std::vector<Subtree> subtrees(state.output.size());
+         std::vector<size_t> stack;
+         for (size_t i = 0; i < state.output.size(); ++i)
+         {
+            const Item& item = state.output[i];
+            Subtree& subtree = subtrees[i];
+            if (item.op == nullptr)
+            {
+               subtree = Subtree{ item.node_end - item.node_begin, item.token_start, item.token_end, 0, 0 };
+            }
+            else if (item.op->fixity == Fixity::Infix)
+            {
+               size_t rhs = stack.back();
+               stack.pop_back();
+               size_t lhs = stack.back();
+               stack.pop_back();
+               subtree = Subtree{ 1 + subtrees[lhs].node_count + subtrees[rhs].node_count, subtrees[lhs].token_start, subtrees[rhs].token_end, lhs, rhs };
+            }
+            else
+            {
+               size_t operand = stack.back();
+               stack.pop_back();
+               size_t token_start = item.op->fixity == Fixity::Prefix ? item.token_start : subtrees[operand].token_start;
+               size_t token_end = item.op->fixity == Fixity::Prefix ? subtrees[operand].token_end : item.token_end;
+               subtree = Subtree{ 1 + subtrees[operand].node_count, token_start, token_end, operand, operand };
+            }
+            stack.push_back(i);
+         }
+
+         Nodes operand_nodes(nodes.view(nodes.since(state.node_mark)).begin(), nodes.view(nodes.since(state.node_mark)).end());
+         nodes.rollback(state.node_mark);
+
+         // Writes the tree in pre-order, left operands before right ones
+         std::vector<size_t> to_write{ stack.back() };
+         while (!to_write.empty())
+         {
+            size_t i = to_write.back();
+            to_write.pop_back();
+            const Item& item = state.output[i];
+            const Subtree& subtree = subtrees[i];
+            if (item.op == nullptr)
+            {
+               nodes.append(NodeSpan(operand_nodes.data() + (item.node_begin - state.node_mark), subtree.node_count));
+            }
+            else if (item.op->fixity == Fixity::Infix)
+            {
+               Node node(BinaryOperation(item.op->spelling, subtrees[subtree.lhs].node_count, subtrees[subtree.rhs].node_count), subtree.token_start, subtree.token_end);
+               nodes.append(NodeSpan(&node, 1));
+               to_write.push_back(subtree.rhs);
+               to_write.push_back(subtree.lhs);
+            }
+            else
+            {
+               Node node(UnaryOperation(item.op->spelling, subtrees[subtree.lhs].node_count), subtree.token_start, subtree.token_end);
+               nodes.append(NodeSpan(&node, 1));
+               to_write.push_back(subtree.lhs);
+            }
+         }
+      }
+   };
+
+}
@@ -1,7 +1,10 @@
 export module alumi.parser.combinator:repeats;
 
 import :concepts;
+import :stop;
+import :trace;
 
+import alumi.parser.context;
 import alumi.parser.result;
 import alumi.parser.subparser;
 
@@ -11,21 +14,50 @@ export {
    class Repeats
    {
    public:
-      static Result parse(Subparser& parent)
+      //! Nullable, as no repeats at all is a success
+      static constexpr FirstSet first_set()
       {
+         return FirstSet{ first_set_of<T>().tokens, true, first_set_of<T>().recovers };
+      }
 
-         Nodes child_nodes;
+      //! Checks whether the parse should stop before each repeat, which is every statement of a block.
+      //! Ends without trying T where it is bound to fail
+      static Result parse(Subparser& parent)
+      {
+         constexpr FirstSet first = first_set_of<T>();
+         NodeBuffer& nodes = parent.context().nodes();
+         size_t node_mark = nodes.mark();
          while (true)
          {
+            if (parent.context().should_stop())
+            {
+               return stop_parsing(parent, node_mark);
+            }
+            if (first.rules_out(parent.peek_type()))
+            {
+               return Result(Result::Type::Success, parent, nodes.since(node_mark));
+            }
+
+            size_t repeat_mark = nodes.mark();
+            size_t indent_mark = parent.context().indent_stacks().mark();
             Subparser parser = parent.create_child();
+            parent.context().begin_speculation();
             Result res = T::parse(parser);
-            if (res.get_type() == Result::Type::Failure)
+            parent.context().end_speculation();
+            if (failed_on_stop(res))
+            {
+               parent.take_over_from(res.get_subparser());
+               return Result(Result::Type::Failure, parent, nodes.since(node_mark));
+            }
+            else if (res.get_type() == Result::Type::Failure)
             {
-               return Result(Result::Type::Success, parent, child_nodes);
+               nodes.rollback(repeat_mark);
+               parent.context().indent_stacks().rollback(indent_mark);
+               trace_backtrack(parent, res.get_consumed());
+               return Result(Result::Type::Success, parent, nodes.since(node_mark));
             }
             else
             {
-               child_nodes.insert(child_nodes.end(), res.get_nodes().begin(), res.get_nodes().end());
                parent.take_over_from(res.get_subparser());
             }
          }
@@ -5,7 +5,10 @@ module;
 export module alumi.parser.combinator:repeats_with_seperator;
 
 import :concepts;
+import :stop;
+import :trace;
 
+import alumi.parser.context;
 import alumi.parser.result;
 import alumi.parser.subparser;
 
@@ -17,30 +20,58 @@ export {
    class RepeatsWithSeperator
    {
    public:
+      static constexpr FirstSet first_set()
+      {
+         return FirstSet{ first_set_of<T>().tokens, true, first_set_of<T>().recovers };
+      }
+
+      //! Ends without trying T where it is bound to fail
       static Result parse(Subparser& parent)
       {
          size_t repeats = 0;
 
-         Nodes child_nodes;
+         constexpr FirstSet first = first_set_of<T>();
+         NodeBuffer& nodes = parent.context().nodes();
+         size_t node_mark = nodes.mark();
          while (true)
          {
+            if (parent.context().should_stop())
+            {
+               return stop_parsing(parent, node_mark);
+            }
+            if (first.rules_out(parent.peek_type()))
+            {
+               return Result(Result::Type::Success, parent, nodes.since(node_mark));
+            }
+
+            size_t repeat_mark = nodes.mark();
+            size_t indent_mark = parent.context().indent_stacks().mark();
             Subparser parser = parent.create_child();
+            parent.context().begin_speculation();
             Result res = T::parse(parser);
-            if (res.get_type() == Result::Type::Failure)
+            parent.context().end_speculation();
+            if (failed_on_stop(res))
+            {
+               parent.take_over_from(res.get_subparser());
+               return Result(Result::Type::Failure, parent, nodes.since(node_mark));
+            }
+            else if (res.get_type() == Result::Type::Failure)
             {
-               return Result(Result::Type::Success, parent, child_nodes);
+               nodes.rollback(repeat_mark);
+               parent.context().indent_stacks().rollback(indent_mark);
+               trace_backtrack(parent, res.get_consumed());
+               return Result(Result::Type::Success, parent, nodes.since(node_mark));
             }
             else
             {
-               child_nodes.insert(child_nodes.end(), res.get_nodes().begin(), res.get_nodes().end());
                parent.take_over_from(res.get_subparser());
-               if (parent.peek().type() == seperator)
+               if (parent.peek_type() == seperator)
                {
                   parent.advance();
                }
                else
                {
-                  return Result(Result::Type::Success, parent, child_nodes);
+                  return Result(Result::Type::Success, parent, nodes.since(node_mark));
                }
             }
          }
@@ -2,18 +2,42 @@ module;
 
 #include "alumi/lexer/token.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 export module alumi.parser.combinator:rule;
 
 import :concepts;
+import :stop;
+import :trace;
 
+import alumi.parser.context;
 import alumi.parser.result;
 import alumi.parser.subparser;
 import alumi.syntax_tree.nodes;
 
 using namespace alumi;
 
+//!
+//! Resumes parsing after the token at the recovery index, unless there is none 
+//! 
+inline void recover_at(Subparser& parser, uint32_t recovery)
+{
+   if (recovery == TokenIndex::NONE)
+   {
+      return;
+   }
+
+   Subparser synch_parser = parser;
+   synch_parser.restart_parsing();
+   synch_parser.advance_past(recovery);
+   parser.take_over_from(synch_parser);
+   parser.clear_panic();
+}
+
 export {
 
    class NeverSynchroize
@@ -26,89 +50,139 @@ export {
    };
 
 
+   //!
+   //! Recovers after the closer that balances the tokens parsed so far, counting from the start of the failed rule
+   //! 
    template <TokenType opener, TokenType closer>
    class SynchronzieOnMatchedPair
    {
    public:
       static void do_synch(Subparser& parser)
       {
-         Subparser synch_parser = parser;
-         synch_parser.restart_parsing();
-         size_t imbalance = 1;
-         while (true)
+         if (parser.is_swallowed(closer))
          {
-            Token token = synch_parser.advance();
-            if (token.type() == TokenType::EndOfFile)
-            {
-               return;
-            }
-            if (token.type() == opener)
-            {
-               imbalance += 1;
-            }
-            if (token.type() == closer)
-            {
-               imbalance -= 1;
-               if (imbalance <= 1)
-               {
-                  parser.take_over_from(synch_parser);
-                  parser.clear_panic();
-                  return;
-               }
-            }
-
+            return;
          }
+
+         TokenIndex& index = parser.context().token_index();
+         uint32_t recovery = parser.is_swallowed(opener) 
+            ? index.next_of_type(parser.token_types(), closer, parser.start_token_index())
+            : index.unmatched_closer(parser.token_types(), opener, closer, parser.start_token_index());
+         recover_at(parser, recovery);
       }
    };
 
+   //!
+   //! Recovers after the next closer, counting from the start of the failed rule
+   //! 
    template <TokenType closer>
    class SynchronizeOnToken
    {
    public:
       static void do_synch(Subparser& parser)
       {
-         Subparser synch_parser = parser;
-         synch_parser.restart_parsing();
-         while (true)
+         if (parser.is_swallowed(closer))
          {
-            Token token = synch_parser.advance();
-            if (token.type() == TokenType::EndOfFile)
-            {
-               return;
-            }
-            if (token.type() == closer)
-            {
-               parser.take_over_from(synch_parser);
-               parser.clear_panic();
-               return;
-            }
+            return;
          }
+
+         uint32_t recovery = parser.context().token_index().next_of_type(parser.token_types(), closer, parser.start_token_index());
+         recover_at(parser, recovery);
       }
    };
 
 
-
    template <typename T>
    concept SynchronizeT = requires (Subparser & parser) { T::do_synch(parser); };
 
+   //!
+   //! Parses T as a single rule, building its node with FuncT and synchronizing with SynchT on failure
+   //! 
+   //! If the parse context memoizes, the outcome is remembered per starting token, so the 
+   //! backtracking of AnyOf only ever parses the rule once from each token. The nodes stay in the node
+   //! buffer, kept through the rollbacks, rather than being copied for every rule above
+   //! 
    template<ParserElement T, SynchronizeT SynchT, std::optional<Node>(*FuncT)(const Result&)>
    class ParseRule
    {
    public:
+      static constexpr FirstSet first_set()
+      {
+         FirstSet first = first_set_of<T>();
+         first.recovers = first.recovers || !std::is_same_v<SynchT, NeverSynchroize>;
+         return first;
+      }
+
       static Result parse(Subparser& parser)
       {
+         ParseContext& context = parser.context();
+         if (!context.is_memoizing())
+         {
+            return parse_rule(parser);
+         }
+
+         ParserState entry_state = parser.state();
+         if (MemoizedResult* memoized = context.find_memoized(&s_rule_id, entry_state))
+         {
+            // Unless the nodes were overwritten since, in which case the rule is parsed again
+            if (std::optional<NodeRange> range = context.nodes().reuse(memoized->nodes))
+            {
+               trace_memo_hit(parser);
+               memoized->nodes = context.nodes().keep(*range);
+               parser.resume_from(memoized->end_state);
+               return Result(memoized->type, parser, *range);
+            }
+         }
+
+         Result res = parse_rule(parser);
+         if (failed_on_stop(res))
+         {
+            return res;
+         }
+         NodeRange range = context.nodes().compact(res.get_node_range());
+         context.memoize(&s_rule_id, std::move(entry_state), MemoizedResult{ res.get_type(), parser.state(), context.nodes().keep(range) });
+         return Result(res.get_type(), parser, range);
+      }
+
+   private:
+      static constexpr char s_rule_id = 0;
+
+      static Result parse_rule(Subparser& parser)
+      {
+         // The rule's node goes in front of the nodes of its children
+         NodeBuffer& nodes = parser.context().nodes();
+         size_t node_mark = nodes.mark();
+         size_t slot = nodes.reserve_slot();
+
          Subparser child = parser.create_child();
          Result res = T::parse(child);
+         if (failed_on_stop(res))
+         {
+            // The builders are skipped for the rest of the parse, the rule that started it puts its nodes together
+            nodes.remove_slot(slot);
+            parser.take_over_from(res.get_subparser());
+            parser.do_panic(res.get_subparser().start_token_index());
+            return Result(Result::Type::Failure, parser, nodes.since(std::min(slot + 1, nodes.mark())));
+         }
+         // The builder views the nodes, so the slots removed among them have to be dropped first
+         NodeRange children = nodes.compact(res.get_node_range());
+         if (children != res.get_node_range())
+         {
+            res = Result(res.get_type(), res.get_subparser(), children);
+         }
 
-         Nodes nodes;
          auto node_opt = FuncT(res);
          if (node_opt.has_value())
          {
-            nodes.push_back(*node_opt);
+            nodes.fill_slot(slot, *node_opt);
+         }
+         else
+         {
+            nodes.remove_slot(slot);
+            // Unless it was the last node, the slot stays behind as a tombstone that the rule's nodes start past
+            node_mark = std::min(slot + 1, nodes.mark());
          }
 
-
-         nodes.insert(nodes.end(), res.get_nodes().begin(), res.get_nodes().end());
          parser.take_over_from(res.get_subparser());
          if (res.get_type() == Result::Type::Failure)
          {
@@ -116,10 +190,15 @@ export {
             SynchT::do_synch(parser);
             if (!parser.is_panicing())
             {
-               return Result(Result::Type::RecoveredFailure, parser, nodes);
+               // The error just recovered from may be the one that reaches max_errors
+               if (parser.context().should_stop())
+               {
+                  return stop_parsing(parser, node_mark);
+               }
+               return Result(Result::Type::RecoveredFailure, parser, nodes.since(node_mark));
             }
          }
-         return Result(res.get_type(), parser, nodes);
+         return Result(res.get_type(), parser, nodes.since(node_mark));
       }
    };
 
@@ -2,6 +2,7 @@ export module alumi.parser.combinator:sequence;
 
 import :concepts;
 
+import alumi.parser.context;
 import alumi.parser.result;
 import alumi.parser.subparser;
 
@@ -11,22 +12,44 @@ export {
    class Sequence
    {
    public:
+      static constexpr FirstSet first_set()
+      {
+         return sequence_first_set<Ts...>();
+      }
+
       static Result parse(Subparser& parent)
       {
          State state;
-         Result res = do_parse<Ts...>(parent, state);
-         return Result(state.worst_result, parent, state.child_nodes);
+         state.node_mark = parent.context().nodes().mark();
+         (parse_element<Ts>(parent, state) && ...);
+         return Result(state.worst_result, parent, parent.context().nodes().since(state.node_mark));
       }
    private:
+      //! Elements after the first one that is not nullable are never looked at, so they may still be incomplete
+      template<ParserElement ElemT, ParserElement... OthersT>
+      static constexpr FirstSet sequence_first_set()
+      {
+         constexpr FirstSet first = first_set_of<ElemT>();
+         if constexpr (first.nullable && sizeof...(OthersT) > 0)
+         {
+            return FirstSet{ first.tokens, false, first.recovers } | sequence_first_set<OthersT...>();
+         }
+         else
+         {
+            return first;
+         }
+      }
+
       class State
       {
       public:
          Result::Type worst_result = Result::Type::Success;
-         Nodes child_nodes;
+         size_t node_mark = 0;
       };
 
+      //! @returns false once the sequence has failed and the remaining elements must not be parsed
       template<ParserElement ElemT>
-      static Result do_parse(Subparser& parent, State& state)
+      static bool parse_element(Subparser& parent, State& state)
       {
          Result res = ElemT::parse(parent);
          if (res.get_type() < state.worst_result)
@@ -34,24 +57,7 @@ export {
             state.worst_result = res.get_type();
          }
 
-         state.child_nodes.insert(state.child_nodes.end(), res.get_nodes().begin(), res.get_nodes().end());
-
-         return res;
-      }
-
-      template<ParserElement ElemT, ParserElement NextT, ParserElement... OthersT>
-      static Result do_parse(Subparser& parent, State& state)
-      {
-         Result res = do_parse<ElemT>(parent, state);
-
-         if (res.get_type() != Result::Type::Failure)
-         {
-            return do_parse<NextT, OthersT...>(parent, state);
-         }
-         else
-         {
-            return Result(state.worst_result, parent, state.child_nodes);
-         }
+         return res.get_type() != Result::Type::Failure;
       }
 
    };
@@ -0,0 +1,38 @@
+module;
+
+#include <cstddef>
+
+export module alumi.parser.combinator:stop;
+
+import alumi.parser.context;
+import alumi.parser.error_codes;
+import alumi.parser.result;
+import alumi.parser.subparser;
+import alumi.syntax_tree.nodes;
+
+using namespace alumi;
+
+export {
+
+   //!
+   //! Fails where the parser is, for a parse that should stop. The nodes from node_mark on are kept
+   //! as what was parsed so far, followed by an Error node with the reason of the stop marking the spot
+   //!
+   inline Result stop_parsing(Subparser& parser, size_t node_mark)
+   {
+      NodeBuffer& nodes = parser.context().nodes();
+      size_t index = parser.current_token_index();
+      nodes.fill_slot(nodes.reserve_slot(), Node(Error(*parser.context().stop_reason(), index, {}), index, index));
+      parser.do_panic(index);
+      return Result(Result::Type::Failure, parser, nodes.since(node_mark));
+   }
+
+   //!
+   //! Whether a child failed because the parse stopped, in which case the failure is passed on instead of backtracked from
+   //!
+   inline bool failed_on_stop(const Result& res)
+   {
+      return res.get_type() == Result::Type::Failure && res.get_subparser().context().is_stopped();
+   }
+
+}
@@ -17,6 +17,12 @@ export {
    class Swallow
    {
    public:
+      //! The swallowed type may come before whatever T starts with
+      static constexpr FirstSet first_set()
+      {
+         return first_set_of<T>() | FirstSet{ swallowed };
+      }
+
       static Result parse(Subparser& parent)
       {
          Subparser parser = parent.create_child();
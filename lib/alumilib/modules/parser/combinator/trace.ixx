@@ -0,0 +1,67 @@
+module;
+
+#include <cstddef>
+#include <string_view>
+
+export module alumi.parser.combinator:trace;
+
+import alumi.parser.context;
+import alumi.parser.result;
+import alumi.parser.subparser;
+
+export {
+
+   //!
+   //! True if the parser is compiled with ALUMI_PARSER_TRACING, which makes rules and combinators feed the
+   //! ParseTracer of their parse. Otherwise the tracing calls compile to nothing
+   //!
+#ifdef ALUMI_PARSER_TRACING
+   constexpr bool PARSER_TRACING = true;
+#else
+   constexpr bool PARSER_TRACING = false;
+#endif
+
+   //!
+   //! Parses a named rule with parse, recording the invocation when tracing
+   //!
+   template<typename ParseT>
+   Result trace_rule(std::string_view rule, Subparser& parser, ParseT parse)
+   {
+      if constexpr (PARSER_TRACING)
+      {
+         ParseTracer& tracer = parser.context().tracer();
+         size_t start = parser.current_token_index();
+         tracer.enter(rule, start);
+         Result res = parse();
+         tracer.leave(res.get_type(), parser.current_token_index() - start);
+         return res;
+      }
+      else
+      {
+         return parse();
+      }
+   }
+
+   //!
+   //! Records that a combinator discarded the tokens a child consumed
+   //!
+   inline void trace_backtrack(Subparser& parser, size_t tokens)
+   {
+      if constexpr (PARSER_TRACING)
+      {
+         parser.context().tracer().backtrack(tokens);
+      }
+   }
+
+   //!
+   //! Records that a rule was answered from the memo
+   //!
+   inline void trace_memo_hit(Subparser& parser)
+   {
+      if constexpr (PARSER_TRACING)
+      {
+         parser.context().tracer().memo_hit();
+      }
+   }
+
+}
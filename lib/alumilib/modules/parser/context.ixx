@@ -0,0 +1,1098 @@
+module;
+
+#include "alumi/lexer/token.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stop_token>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+export module alumi.parser.context;
+
+import alumi.parser.error_codes;
+import alumi.syntax_tree.nodes;
+
+using namespace alumi;
+
+//!
+//! How a parsing attempt ended
+//!
+export enum class ResultType
+{
+   Failure,
+   RecoveredFailure,
+   Success
+};
+
+//!
+//! Options controlling a single parse
+//!
+export struct ParseOptions
+{
+   //! Remembers the outcome of each rule at each token, so backtracking never parses the same
+   //! rule from the same token twice, at the cost of keeping every outcome alive for the parse
+   bool memoize = false;
+
+   //! Skims the indented bodies of functions instead of parsing them, leaving DeferredBlock nodes
+   //! to be parsed when needed. For tooling that only needs the top level structure
+   bool defer_blocks = false;
+
+   //! Threads to parse the top level statements of a module on. With more than one, the module is split at
+   //! every line starting at column zero and the slices are parsed independently, then spliced together
+   size_t threads = 1;
+
+   //! Parses the bodies of functions one at a time from a work list instead of recursing into them, so
+   //! how deeply they nest is bounded by the heap rather than the native stack. Overrides defer_blocks.
+   //! Errors in a body are recovered from within that body, the code around it parses as if it had none
+   bool iterative = false;
+
+   //! Stops the parse once a stop is requested on it. A stopped parse fails where it was when it noticed,
+   //! with the nodes parsed so far followed by an Error node with ErrorCode::Cancelled
+   std::stop_token stop_token;
+
+   //! Stops the parse as stop_token does, once the clock passes it
+   std::optional<std::chrono::steady_clock::time_point> deadline;
+
+   //! Stops the parse as stop_token does once this many Error nodes were kept, marking where with
+   //! ErrorCode::TooManyErrors instead. With 1 the parse fails on the first error it would recover from,
+   //! for when all that matters is whether the text is valid. 0 for no limit
+   size_t max_errors = 0;
+};
+
+//!
+//! Every indent stack of a parse, kept as a tree where each entry links to the entry below it.
+//! A stack is then just the id of its top entry, which is cheap to copy and to restore,
+//! and pushing never changes a stack some other subparser still holds
+//!
+//! Like the NodeBuffer, a combinator marks the entries before trying a child and rolls back to the
+//! mark if it discards the child, so backtracking does not grow the entries without bound
+//!
+export class IndentStacks
+{
+public:
+   using Id = uint32_t;
+
+   //! The empty stack
+   static constexpr Id EMPTY = std::numeric_limits<Id>::max();
+
+   Id push(Id stack, size_t indent)
+   {
+      m_entries.push_back(Entry{ indent, stack });
+      return static_cast<Id>(m_entries.size() - 1);
+   }
+
+   size_t mark() const
+   {
+      return m_entries.size();
+   }
+
+   //!
+   //! Drops the entries pushed since the mark, unless they were kept. Only stacks that were
+   //! discarded along with the child may still refer to them
+   //!
+   void rollback(size_t mark)
+   {
+      m_entries.resize(std::max(mark, m_kept));
+   }
+
+   //!
+   //! Keeps the stack and every entry below it through later rollbacks, for stacks that outlive
+   //! the child they were pushed by, as those in the memo do
+   //!
+   void keep(Id stack)
+   {
+      if (stack != EMPTY)
+      {
+         m_kept = std::max(m_kept, static_cast<size_t>(stack) + 1);
+      }
+   }
+
+   Id pop(Id stack) const
+   {
+      return m_entries[stack].below;
+   }
+
+   //! Whether two stacks hold the same indents, wherever they were pushed
+   bool equal(Id left, Id right) const
+   {
+      while (left != right)
+      {
+         if (left == EMPTY || right == EMPTY || m_entries[left].indent != m_entries[right].indent)
+         {
+            return false;
+         }
+         left = m_entries[left].below;
+         right = m_entries[right].below;
+      }
+      return true;
+   }
+
+   std::optional<size_t> top(Id stack) const
+   {
+      if (stack == EMPTY)
+      {
+         return std::nullopt;
+      }
+      return m_entries[stack].indent;
+   }
+
+private:
+   struct Entry
+   {
+      size_t indent;
+      Id below;
+   };
+
+   std::vector<Entry> m_entries;
+   // Rollbacks never go below this
+   size_t m_kept = 0;
+};
+
+//!
+//! For each set of swallowed token types in use, links from every token index to the first index at or after it
+//! that is not swallowed, so skipping swallowed tokens is a single lookup. Built on first use of each set, and
+//! extended over the new tokens if the stream has grown since
+//!
+export class SkipLinks
+{
+public:
+   using Links = std::vector<uint32_t>;
+
+   //!
+   //! The links for a swallowed set, with one extra entry for the end of the token stream.
+   //! The references stay valid for the lifetime of this
+   //!
+   const Links& links_for(std::span<const TokenType> types, TokenTypeSet swallowed)
+   {
+      for (auto& entry : m_tables)
+      {
+         if (entry.swallowed == swallowed)
+         {
+            extend(entry.links, types, swallowed);
+            return entry.links;
+         }
+      }
+
+      Links& links = m_tables.emplace_back(Table{ swallowed, Links{ 0 } }).links;
+      extend(links, types, swallowed);
+      return links;
+   }
+
+private:
+   //! Extends links over the tokens past the end they were built for
+   static void extend(Links& links, std::span<const TokenType> types, TokenTypeSet swallowed)
+   {
+      size_t old_end = links.size() - 1;
+      if (old_end == types.size())
+      {
+         return;
+      }
+      links.resize(types.size() + 1);
+      links[types.size()] = static_cast<uint32_t>(types.size());
+      for (size_t i = types.size(); i > old_end; --i)
+      {
+         links[i - 1] = swallowed.contains(types[i - 1]) ? links[i] : static_cast<uint32_t>(i - 1);
+      }
+      // The swallowed tokens right before the old end linked to it, they now skip on to where it does
+      for (size_t i = old_end; i > 0 && links[i - 1] == old_end; --i)
+      {
+         links[i - 1] = links[old_end];
+      }
+   }
+
+   struct Table
+   {
+      TokenTypeSet swallowed;
+      Links links;
+   };
+
+   // A deque, so the links handed out are not moved as sets are added
+   std::deque<Table> m_tables;
+};
+
+//!
+//! Where error synchronization can recover to from each token, so a synchronizer does not walk the tokens in
+//! between one by one. Searches for a single type scan the packed token types with memchr, which is vectorized,
+//! matched pairs jump through a table built on first use. The tables follow the token stream if it grows
+//!
+export class TokenIndex
+{
+public:
+   //! Marks that there is no recovery point before the end of the token stream
+   static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+   //! The first token of the type at or after from, NONE if the end of the file comes first
+   uint32_t next_of_type(std::span<const TokenType> types, TokenType type, size_t from)
+   {
+      if (from >= types.size())
+      {
+         return NONE;
+      }
+      static_assert(sizeof(TokenType) == 1, "Token types are searched for as bytes");
+      const void* found = std::memchr(types.data() + from, static_cast<int>(type), types.size() - from);
+      if (found == nullptr)
+      {
+         return NONE;
+      }
+      size_t index = static_cast<const TokenType*>(found) - types.data();
+      return type == TokenType::EndOfFile ? NONE : static_cast<uint32_t>(index);
+   }
+
+   //!
+   //! The closer of the first opener or closer at or after from. For a closer that is the token itself, whether
+   //! or not an opener before from matches it, for an opener it is the closer that balances it, NONE if it is never
+   //! balanced. NONE as well if the end of the file comes first. If opener and closer are the same it is simply
+   //! the next one
+   //!
+   uint32_t unmatched_closer(std::span<const TokenType> types, TokenType opener, TokenType closer, size_t from)
+   {
+      if (opener == closer)
+      {
+         return next_of_type(types, closer, from);
+      }
+      return find_or_build(types, opener, closer, from);
+   }
+
+   //! Indices of the indent tokens in [from, to)
+   std::span<const uint32_t> indents_between(std::span<const TokenType> types, size_t from, size_t to)
+   {
+      for (size_t i = next_of_type(types, TokenType::Indent, m_indents_scanned); i != NONE; i = next_of_type(types, TokenType::Indent, i + 1))
+      {
+         m_indents.push_back(static_cast<uint32_t>(i));
+      }
+      m_indents_scanned = std::max(m_indents_scanned, types.size());
+      auto first = std::lower_bound(m_indents.begin(), m_indents.end(), from);
+      auto last = std::lower_bound(first, m_indents.end(), to);
+      return std::span<const uint32_t>(m_indents.data() + (first - m_indents.begin()), last - first);
+   }
+
+private:
+   struct Table
+   {
+      TokenType opener;
+      TokenType closer;
+      std::vector<uint32_t> recovery;
+   };
+
+   uint32_t find_or_build(std::span<const TokenType> types, TokenType opener, TokenType closer, size_t from)
+   {
+      for (auto& table : m_tables)
+      {
+         if (table.opener == opener && table.closer == closer)
+         {
+            // New tokens can balance openers that were not before, so the table is built again
+            if (table.recovery.size() != types.size() + 1)
+            {
+               table.recovery = build(types, opener, closer);
+            }
+            return from < types.size() ? table.recovery[from] : NONE;
+         }
+      }
+      m_tables.push_back(Table{ opener, closer, build(types, opener, closer) });
+      return from < types.size() ? m_tables.back().recovery[from] : NONE;
+   }
+
+   static std::vector<uint32_t> build(std::span<const TokenType> types, TokenType opener, TokenType closer)
+   {
+      // Each opener is first matched to its closer, then going backwards a closer recovers at
+      // itself, an opener at its match and any other token wherever the token after it does
+      std::vector<uint32_t> match(types.size(), NONE);
+      std::vector<uint32_t> open;
+      for (size_t i = 0; i < types.size(); ++i)
+      {
+         if (types[i] == opener)
+         {
+            open.push_back(static_cast<uint32_t>(i));
+         }
+         else if (types[i] == closer && !open.empty())
+         {
+            match[open.back()] = static_cast<uint32_t>(i);
+            open.pop_back();
+         }
+      }
+
+      std::vector<uint32_t> recovery(types.size() + 1, NONE);
+      for (size_t i = types.size(); i > 0; --i)
+      {
+         size_t index = i - 1;
+         TokenType type = types[index];
+         if (type == TokenType::EndOfFile)
+         {
+            recovery[index] = NONE;
+         }
+         else if (type == closer)
+         {
+            recovery[index] = static_cast<uint32_t>(index);
+         }
+         else if (type == opener)
+         {
+            // An unmatched opener is never balanced again, leaving its match as NONE
+            recovery[index] = match[index];
+         }
+         else
+         {
+            recovery[index] = recovery[index + 1];
+         }
+      }
+      return recovery;
+   }
+
+   std::vector<Table> m_tables;
+   std::vector<uint32_t> m_indents;
+   // The tokens m_indents covers
+   size_t m_indents_scanned = 0;
+};
+
+//!
+//! A range of nodes in a NodeBuffer, from begin up to but not including end
+//!
+export struct NodeRange
+{
+   size_t begin = 0;
+   size_t end = 0;
+
+   size_t size() const
+   {
+      return end - begin;
+   }
+
+   bool operator==(const NodeRange& other) const = default;
+};
+
+//!
+//! Nodes kept for reuse through the rollbacks of the buffer, see NodeBuffer::keep
+//!
+export struct KeptRange
+{
+   NodeRange range;
+   // The ranges kept before this one, a node written since has a larger stamp
+   uint32_t stamp = 0;
+};
+
+//!
+//! Every node of a parse, in a single buffer that rules append to as they succeed. A combinator
+//! marks the buffer before trying a child and rolls back to the mark if it discards the child,
+//! so a node is written once instead of being copied into the result of every rule above it
+//!
+//! A removed slot is left behind as a tombstone, so a range has to be compacted before its nodes are viewed
+//!
+//! Like the IndentStacks, the buffer keeps the nodes of the ranges the memo holds on to through rollbacks. They
+//! stay where they were until overwritten, so a rule parsed again where its nodes still are takes them back in place
+//!
+export class NodeBuffer
+{
+public:
+   //! @param count_errors   whether to keep count of the Error nodes in the buffer, which costs a look at every node added or removed
+   explicit NodeBuffer(bool count_errors = false)
+      : m_count_errors(count_errors)
+   {
+   }
+
+   size_t mark() const
+   {
+      return m_size;
+   }
+
+   //! The nodes appended since the mark
+   NodeRange since(size_t mark) const
+   {
+      return NodeRange{ mark, m_size };
+   }
+
+   void rollback(size_t mark)
+   {
+      m_error_count -= count_errors(NodeSpan(m_nodes.data() + mark, m_size - mark));
+      m_size = mark;
+      truncate(std::max(mark, m_kept));
+      while (!m_tombstones.empty() && m_tombstones.back() >= mark)
+      {
+         m_tombstones.pop_back();
+      }
+   }
+
+   void append(NodeSpan nodes)
+   {
+      m_error_count += count_errors(nodes);
+      for (const Node& node : nodes)
+      {
+         push(node);
+      }
+   }
+
+   //!
+   //! Appends a placeholder for a node that has to precede nodes that are not yet parsed,
+   //! it must later be filled in or removed
+   //!
+   size_t reserve_slot()
+   {
+      push(Node(Expression(), 0, 0));
+      return m_size - 1;
+   }
+
+   void fill_slot(size_t slot, const Node& node)
+   {
+      m_error_count += count_errors(NodeSpan(&node, 1));
+      m_error_count -= count_errors(NodeSpan(&m_nodes[slot], 1));
+      m_nodes[slot] = node;
+      m_stamps[slot] = m_keeps;
+   }
+
+   //!
+   //! Removes a slot that is not filled. The nodes after it are not moved up until a range holding
+   //! the slot is compacted, so a whole run of removed slots costs a single pass
+   //!
+   void remove_slot(size_t slot)
+   {
+      m_error_count -= count_errors(NodeSpan(&m_nodes[slot], 1));
+      if (slot + 1 == m_size)
+      {
+         m_size = slot;
+         truncate(std::max(m_size, m_kept));
+      }
+      else
+      {
+         // The tombstones within a slot are compacted before it is removed, so they stay sorted
+         m_tombstones.push_back(slot);
+      }
+   }
+
+   //!
+   //! Drops the tombstones of removed slots within a range that reaches the end of the buffer,
+   //! and returns the range its nodes are in afterwards
+   //!
+   NodeRange compact(NodeRange range)
+   {
+      auto first = std::lower_bound(m_tombstones.begin(), m_tombstones.end(), range.begin);
+      if (first == m_tombstones.end() || *first >= range.end)
+      {
+         return range;
+      }
+
+      size_t kept = *first;
+      auto tombstone = first;
+      for (size_t index = *first; index < m_size; ++index)
+      {
+         if (tombstone != m_tombstones.end() && *tombstone == index)
+         {
+            ++tombstone;
+            continue;
+         }
+         m_nodes[kept] = std::move(m_nodes[index]);
+         ++kept;
+      }
+      // Every node from the first tombstone on was moved, or left moved from
+      std::fill(m_stamps.begin() + *first, m_stamps.begin() + m_size, m_keeps);
+      m_size = kept;
+      truncate(std::max(m_size, m_kept));
+      m_tombstones.erase(first, m_tombstones.end());
+      return NodeRange{ range.begin, m_size };
+   }
+
+   //!
+   //! Keeps the nodes of a compacted range through later rollbacks, until they are overwritten. The nodes
+   //! past the kept ones are still dropped on a rollback
+   //!
+   KeptRange keep(NodeRange range)
+   {
+      m_kept = std::max(m_kept, range.end);
+      return KeptRange{ range, m_keeps++ };
+   }
+
+   //!
+   //! Appends the nodes of a kept range again, and returns where they are now. If the buffer was rolled back to
+   //! just before them they are taken back where they are, otherwise they are copied. nullopt if they were overwritten
+   //!
+   std::optional<NodeRange> reuse(const KeptRange& kept)
+   {
+      NodeRange range = kept.range;
+      if (range.end > m_nodes.size() 
+         || std::any_of(m_stamps.begin() + range.begin, m_stamps.begin() + range.end, [&](uint32_t stamp) { return stamp > kept.stamp; }))
+      {
+         return std::nullopt;
+      }
+
+      NodeSpan nodes(m_nodes.data() + range.begin, range.size());
+      m_error_count += count_errors(nodes);
+      if (range.begin == m_size)
+      {
+         m_size = range.end;
+         return range;
+      }
+
+      size_t begin = m_size;
+      if (range.end <= m_size)
+      {
+         // Writing past the end of the buffer does not touch them, once it no longer has to grow
+         m_nodes.reserve(m_size + range.size());
+         m_stamps.reserve(m_size + range.size());
+         for (size_t index = range.begin; index < range.end; ++index)
+         {
+            push(m_nodes[index]);
+         }
+      }
+      else
+      {
+         // The nodes are past the end, where they would be overwritten while copying them
+         Nodes copy(nodes.begin(), nodes.end());
+         for (const Node& node : copy)
+         {
+            push(node);
+         }
+      }
+      return NodeRange{ begin, m_size };
+   }
+
+   //! The Error nodes in the buffer, always 0 unless the buffer counts them
+   size_t error_count() const
+   {
+      return m_error_count;
+   }
+
+   NodeSpan view(NodeRange range) const
+   {
+      return NodeSpan(m_nodes.data() + range.begin, range.size());
+   }
+
+private:
+   size_t count_errors(NodeSpan nodes) const
+   {
+      if (!m_count_errors)
+      {
+         return 0;
+      }
+      return std::count_if(nodes.begin(), nodes.end(), [](const Node& node) { return node.is<Error>(); });
+   }
+
+   void push(const Node& node)
+   {
+      if (m_size < m_nodes.size())
+      {
+         m_nodes[m_size] = node;
+         m_stamps[m_size] = m_keeps;
+      }
+      else
+      {
+         m_nodes.push_back(node);
+         m_stamps.push_back(m_keeps);
+      }
+      m_size += 1;
+   }
+
+   //! Drops the nodes past the end of the buffer from the given size on
+   void truncate(size_t size)
+   {
+      if (m_nodes.size() > size)
+      {
+         m_nodes.erase(m_nodes.begin() + size, m_nodes.end());
+         m_stamps.resize(size);
+      }
+   }
+
+   // The nodes of the buffer, followed by nodes that were rolled back but are kept
+   Nodes m_nodes;
+   // When each node was last written, as the number of ranges kept by then
+   std::vector<uint32_t> m_stamps;
+   size_t m_size = 0;
+   // The end of the kept ranges, rollbacks leave the nodes before it in place
+   size_t m_kept = 0;
+   uint32_t m_keeps = 0;
+   // Indices of the removed slots still in m_nodes, ascending
+   std::vector<size_t> m_tombstones;
+   bool m_count_errors;
+   size_t m_error_count = 0;
+};
+
+//!
+//! Snapshot of everything in a subparser that decides how a rule parses, and where it leaves off
+//!
+export struct ParserState
+{
+   size_t start;
+   size_t current;
+   IndentStacks::Id indent_stack;
+   TokenTypeSet swallowed;
+   std::optional<size_t> panic_token_index;
+
+   bool operator==(const ParserState& other) const = default;
+};
+
+//!
+//! The outcome of a rule, with the state of the parser it was applied to afterwards
+//!
+export struct MemoizedResult
+{
+   ResultType type;
+   ParserState end_state;
+   // Kept in the node buffer, where the rule put them
+   KeptRange nodes;
+};
+
+//!
+//! What a parse spent on a single rule
+//!
+export struct RuleStatistics
+{
+   std::string_view rule;
+   size_t invocations = 0;
+   size_t failures = 0;
+   size_t recovered_failures = 0;
+   size_t tokens_consumed = 0;
+   //! Tokens consumed by children of the rule that were then discarded, such as failed alternatives
+   size_t tokens_backtracked = 0;
+   size_t memo_hits = 0;
+   //! Time spent in the rule, including the rules it called
+   std::chrono::nanoseconds total_time{};
+   //! Time spent in the rule, excluding the rules it called
+   std::chrono::nanoseconds self_time{};
+};
+
+//!
+//! Records every rule of a parse as it is entered and left, for finding the rules worth refactoring or memoizing.
+//! It is only fed when the parser is compiled with ALUMI_PARSER_TRACING defined
+//!
+export class ParseTracer
+{
+public:
+   void enter(std::string_view rule, size_t token_index)
+   {
+      RuleStatistics& statistics = m_statistics[rule];
+      statistics.rule = rule;
+      m_frames.push_back(Frame{ &statistics, token_index, Clock::now(), {} });
+   }
+
+   void leave(ResultType type, size_t consumed)
+   {
+      Frame frame = m_frames.back();
+      m_frames.pop_back();
+      auto duration = Clock::now() - frame.start;
+
+      RuleStatistics& statistics = *frame.statistics;
+      statistics.invocations += 1;
+      statistics.failures += type == ResultType::Failure ? 1 : 0;
+      statistics.recovered_failures += type == ResultType::RecoveredFailure ? 1 : 0;
+      statistics.tokens_consumed += consumed;
+      // Recursive rules would count their time once per level, so only the outermost invocation adds to it
+      if (std::none_of(m_frames.begin(), m_frames.end(), [&](const Frame& outer) { return outer.statistics == frame.statistics; }))
+      {
+         statistics.total_time += duration;
+      }
+      statistics.self_time += duration - frame.child_time;
+      if (!m_frames.empty())
+      {
+         m_frames.back().child_time += duration;
+      }
+
+      m_events.push_back(Event{ statistics.rule, frame.token_index, consumed, type, frame.start, duration });
+   }
+
+   //! Records that the innermost rule discarded tokens consumed by one of its children
+   void backtrack(size_t tokens)
+   {
+      if (!m_frames.empty())
+      {
+         m_frames.back().statistics->tokens_backtracked += tokens;
+      }
+   }
+
+   //! Records that the innermost rule was answered from the memo
+   void memo_hit()
+   {
+      if (!m_frames.empty())
+      {
+         m_frames.back().statistics->memo_hits += 1;
+      }
+   }
+
+   //! The statistics of every rule, the one that took the most time first
+   std::vector<RuleStatistics> statistics() const
+   {
+      std::vector<RuleStatistics> sorted;
+      for (const auto& [rule, statistics] : m_statistics)
+      {
+         sorted.push_back(statistics);
+      }
+      std::sort(sorted.begin(), sorted.end(), [](const RuleStatistics& l, const RuleStatistics& r) { return l.total_time > r.total_time; });
+      return sorted;
+   }
+
+   //! Writes the statistics as a table
+   void write_report(std::ostream& out) const
+   {
+      out << fmt::format("{:<32} {:>10} {:>10} {:>10} {:>10} {:>12} {:>10} {:>12} {:>12}\n",
+         "Rule", "Calls", "Failures", "Recovered", "Consumed", "Backtracked", "Memo hits", "Total ms", "Self ms");
+      for (const RuleStatistics& statistics : this->statistics())
+      {
+         out << fmt::format("{:<32} {:>10} {:>10} {:>10} {:>10} {:>12} {:>10} {:>12.3f} {:>12.3f}\n",
+            statistics.rule, statistics.invocations, statistics.failures, statistics.recovered_failures,
+            statistics.tokens_consumed, statistics.tokens_backtracked, statistics.memo_hits,
+            std::chrono::duration<double, std::milli>(statistics.total_time).count(),
+            std::chrono::duration<double, std::milli>(statistics.self_time).count());
+      }
+   }
+
+   //! Writes every rule invocation in the Chrome trace event format, as loaded by chrome://tracing or Perfetto
+   void write_chrome_trace(std::ostream& out) const
+   {
+      out << "{\"traceEvents\":[";
+      for (size_t i = 0; i < m_events.size(); ++i)
+      {
+         const Event& event = m_events[i];
+         out << fmt::format("{}\n{{\"name\":\"{}\",\"cat\":\"rule\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":{:.3f},\"dur\":{:.3f},"
+            "\"args\":{{\"token\":{},\"consumed\":{},\"result\":\"{}\"}}}}",
+            i == 0 ? "" : ",", event.rule,
+            std::chrono::duration<double, std::micro>(event.start - m_origin).count(),
+            std::chrono::duration<double, std::micro>(event.duration).count(),
+            event.token_index, event.consumed, result_name(event.type));
+      }
+      out << "\n]}\n";
+   }
+
+private:
+   using Clock = std::chrono::steady_clock;
+
+   struct Frame
+   {
+      RuleStatistics* statistics;
+      size_t token_index;
+      Clock::time_point start;
+      std::chrono::nanoseconds child_time;
+   };
+
+   struct Event
+   {
+      std::string_view rule;
+      size_t token_index;
+      size_t consumed;
+      ResultType type;
+      Clock::time_point start;
+      std::chrono::nanoseconds duration;
+   };
+
+   static std::string_view result_name(ResultType type)
+   {
+      switch (type)
+      {
+      case ResultType::Failure:
+         return "Failure";
+      case ResultType::RecoveredFailure:
+         return "RecoveredFailure";
+      default:
+         return "Success";
+      }
+   }
+
+   Clock::time_point m_origin = Clock::now();
+   std::vector<Frame> m_frames;
+   // Node based, so the statistics frames point to stay where they are
+   std::unordered_map<std::string_view, RuleStatistics> m_statistics;
+   std::vector<Event> m_events;
+};
+
+//!
+//! State shared by every subparser of a single parse
+//!
+export class ParseContext
+{
+public:
+   //! Unique per rule, the address of a tag the rule owns
+   using RuleId = const void*;
+
+   //!
+   //! @param options      how to parse
+   //! @param source       the text the tokens were lexed from, for rules that look at the spelling of tokens
+   //! @param token_types  the types of the tokens, as in TokenColumns, built from the tokens if not given
+   //!
+   ParseContext(ParseOptions options = ParseOptions(), std::u8string_view source = std::u8string_view(), std::span<const TokenType> token_types = {})
+      : m_options(options)
+      , m_source(source)
+      , m_nodes(options.max_errors != 0)
+      , m_token_types(token_types)
+   {
+   }
+
+   const ParseOptions& options() const
+   {
+      return m_options;
+   }
+
+   bool is_memoizing() const
+   {
+      return m_options.memoize;
+   }
+
+   //!
+   //! Whether the parse should stop, as a stop was requested, the deadline has passed or max_errors errors
+   //! were committed to. Once true it stays true, so the rules above the one that noticed fail
+   //! rather than parse on. The clock is only read on every DEADLINE_CHECK_INTERVAL-th call
+   //!
+   bool should_stop()
+   {
+      if (!m_stop_reason.has_value())
+      {
+         if (m_options.stop_token.stop_requested() || deadline_passed())
+         {
+            m_stop_reason = ErrorCode::Cancelled;
+         }
+         else if (m_options.max_errors != 0 && committed_errors() >= m_options.max_errors)
+         {
+            m_stop_reason = ErrorCode::TooManyErrors;
+         }
+      }
+      return m_stop_reason.has_value();
+   }
+
+   //! Whether should_stop() found that the parse should stop, without checking again
+   bool is_stopped() const
+   {
+      return m_stop_reason.has_value();
+   }
+
+   //! Why the parse stopped, nullopt if it did not
+   std::optional<ErrorCode> stop_reason() const
+   {
+      return m_stop_reason;
+   }
+
+   //!
+   //! Marks that the nodes added until end_speculation() may still be rolled back, so errors among them do not
+   //! count towards max_errors yet. Every combinator that rolls back a child speculates on it. Speculation nests
+   //!
+   void begin_speculation()
+   {
+      if (m_speculation_depth == 0)
+      {
+         m_errors_before_speculation = m_nodes.error_count();
+      }
+      m_speculation_depth += 1;
+   }
+
+   void end_speculation()
+   {
+      m_speculation_depth -= 1;
+   }
+
+   //! The text of a token, empty if the context was not given the source
+   std::u8string_view token_text(const Token& token) const
+   {
+      if (token.pos().byte_index() + token.size() > m_source.size())
+      {
+         return std::u8string_view();
+      }
+      return m_source.substr(token.pos().byte_index(), token.size());
+   }
+
+   //!
+   //! Looks up the outcome of a rule applied to a parser in the given state, or nullptr if it
+   //! has not been parsed from there
+   //!
+   MemoizedResult* find_memoized(RuleId rule, const ParserState& entry_state)
+   {
+      auto ite = m_memo.find(MemoKey{ rule, entry_state.current });
+      if (ite == m_memo.end())
+      {
+         return nullptr;
+      }
+      // An entry from the same token but in a different indention or swallowing context
+      // could parse differently, so it does not count
+      for (MemoEntry& entry : ite->second)
+      {
+         if (same_state(entry.entry_state, entry_state))
+         {
+            return &entry.result;
+         }
+      }
+      return nullptr;
+   }
+
+   void memoize(RuleId rule, ParserState entry_state, MemoizedResult result)
+   {
+      m_indent_stacks.keep(entry_state.indent_stack);
+      m_indent_stacks.keep(result.end_state.indent_stack);
+      std::vector<MemoEntry>& entries = m_memo[MemoKey{ rule, entry_state.current }];
+      for (MemoEntry& entry : entries)
+      {
+         if (same_state(entry.entry_state, entry_state))
+         {
+            entry.result = std::move(result);
+            return;
+         }
+      }
+      entries.push_back(MemoEntry{ std::move(entry_state), std::move(result) });
+   }
+
+   size_t memoized_count() const
+   {
+      size_t count = 0;
+      for (const auto& [key, entries] : m_memo)
+      {
+         count += entries.size();
+      }
+      return count;
+   }
+
+   IndentStacks& indent_stacks()
+   {
+      return m_indent_stacks;
+   }
+
+   NodeBuffer& nodes()
+   {
+      return m_nodes;
+   }
+
+   //! Skip links for the token stream of this parse
+   SkipLinks& skip_links()
+   {
+      return m_skip_links;
+   }
+
+   //!
+   //! The type of every token of the stream of this parse, packed so that checking the type of a token
+   //! does not have to load the whole token. The types given to the constructor are taken to be those of the
+   //! first tokens asked for. Asking for other tokens builds their types, and drops the recovery points and skip
+   //! links of the tokens before, invalidating what was handed out for them
+   //!
+   std::span<const TokenType> token_types(const std::vector<Token>& tokens)
+   {
+      if (m_typed_tokens == &tokens && m_token_types.size() == tokens.size())
+      {
+         return m_token_types;
+      }
+      if (m_typed_tokens == nullptr && m_token_types.size() == tokens.size())
+      {
+         m_typed_tokens = &tokens;
+         return m_token_types;
+      }
+
+      m_built_token_types.clear();
+      m_built_token_types.reserve(tokens.size());
+      for (const Token& token : tokens)
+      {
+         m_built_token_types.push_back(token.type());
+      }
+      m_token_types = m_built_token_types;
+      m_typed_tokens = &tokens;
+      m_token_index = TokenIndex();
+      m_skip_links = SkipLinks();
+      return m_token_types;
+   }
+
+   //!
+   //! Takes on the tokens a stream got since the context last saw it, tokens being the whole stream so far with
+   //! the tokens before unchanged. Only the new tokens are looked at, the memoized results are dropped as they
+   //! may have ended at the old end of the stream. Invalidates the token types handed out before
+   //!
+   void extend_tokens(const std::vector<Token>& tokens)
+   {
+      if (m_built_token_types.size() != m_token_types.size())
+      {
+         m_built_token_types.assign(m_token_types.begin(), m_token_types.end());
+      }
+      for (size_t i = m_built_token_types.size(); i < tokens.size(); ++i)
+      {
+         m_built_token_types.push_back(tokens[i].type());
+      }
+      m_token_types = m_built_token_types;
+      m_typed_tokens = &tokens;
+      m_memo.clear();
+   }
+
+   //! Recovery points for the token stream of this parse
+   TokenIndex& token_index()
+   {
+      return m_token_index;
+   }
+
+   //! What this parse spent on each rule, if the parser is compiled with ALUMI_PARSER_TRACING
+   ParseTracer& tracer()
+   {
+      return m_tracer;
+   }
+
+   const ParseTracer& tracer() const
+   {
+      return m_tracer;
+   }
+
+private:
+   struct MemoKey
+   {
+      RuleId rule;
+      size_t token_index;
+
+      bool operator==(const MemoKey& other) const = default;
+   };
+
+   struct MemoKeyHash
+   {
+      size_t operator()(const MemoKey& key) const
+      {
+         return std::hash<RuleId>()(key.rule) ^ (std::hash<size_t>()(key.token_index) * 31);
+      }
+   };
+
+   struct MemoEntry
+   {
+      ParserState entry_state;
+      MemoizedResult result;
+   };
+
+   static constexpr size_t DEADLINE_CHECK_INTERVAL = 32;
+
+   //! Whether a rule parses the same from either state, the indent stacks are compared by their indents
+   bool same_state(const ParserState& left, const ParserState& right) const
+   {
+      return left.start == right.start
+         && left.current == right.current
+         && left.swallowed == right.swallowed
+         && left.panic_token_index == right.panic_token_index
+         && m_indent_stacks.equal(left.indent_stack, right.indent_stack);
+   }
+
+   //! The errors that no combinator can roll back anymore, those from before the outermost speculation
+   size_t committed_errors() const
+   {
+      return m_speculation_depth == 0 ? m_nodes.error_count() : m_errors_before_speculation;
+   }
+
+   bool deadline_passed()
+   {
+      if (!m_options.deadline.has_value() || m_deadline_checks++ % DEADLINE_CHECK_INTERVAL != 0)
+      {
+         return false;
+      }
+      return std::chrono::steady_clock::now() >= *m_options.deadline;
+   }
+
+   ParseOptions m_options;
+   std::u8string_view m_source;
+   IndentStacks m_indent_stacks;
+   NodeBuffer m_nodes;
+   SkipLinks m_skip_links;
+   std::span<const TokenType> m_token_types;
+   // Backs m_token_types when they were not given
+   std::vector<TokenType> m_built_token_types;
+   // The tokens m_token_types are the types of, nullptr until a subparser asks for them
+   const std::vector<Token>* m_typed_tokens = nullptr;
+   TokenIndex m_token_index;
+   ParseTracer m_tracer;
+   // A rule may be parsed from a token in several states
+   std::unordered_map<MemoKey, std::vector<MemoEntry>, MemoKeyHash> m_memo;
+   std::optional<ErrorCode> m_stop_reason;
+   size_t m_deadline_checks = 0;
+   size_t m_speculation_depth = 0;
+   size_t m_errors_before_speculation = 0;
+};
@@ -5,6 +5,8 @@ export
    enum class ErrorCode
    {
       Unknown = 0,
-      MismatchedBrackets = 1
+      MismatchedBrackets = 1,
+      Cancelled = 2,
+      TooManyErrors = 3
    };
 }
\ No newline at end of file
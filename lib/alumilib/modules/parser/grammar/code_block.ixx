@@ -14,7 +14,7 @@ import alumi.syntax_tree.node_builder;
 
 using namespace alumi;
 
-std::optional<Node> build_block_node(const Result& res)
+export std::optional<Node> build_block_node(const Result& res)
 {
    if (res.get_type() == Result::Type::Failure)
    {
@@ -22,3 +22,8 @@ std::optional<Node> build_block_node(const Result& res)
    }
    return make_node(CodeBlock(res.get_nodes()), res);
 };
+
+std::optional<Node> build_deferred_block_node(const Result& res)
+{
+   return make_node(DeferredBlock(), res);
+};
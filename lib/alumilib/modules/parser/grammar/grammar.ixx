@@ -4,27 +4,31 @@ module;
 
 #include "alumi/lexer/token.h"
 
+#include <array>
+
 export module alumi.parser.grammar;
 
 import alumi.parser.combinator;
 
 using namespace alumi;
 
+// The block and root builders are exported for assembling a module that was parsed in parts
 import :assignment;
-import :code_block;
+export import :code_block;
 import :expression;
 import :function_call;
 import :function_declaration;
 import :function_definition;
 import :function_parameter;
-import :root;
+export import :root;
 import :statement;
 import :tuple;
 import :value;
 
 namespace grammar 
 {
-class CodeBlock;
+//! Exported so that deferred blocks can be parsed on their own
+export class CodeBlock;
 
 RULE(NewBlock, Indented);
 RULE(EndBlock, AnyOf<Is<TokenType::EndOfFile>, Sequence<Is<TokenType::Linebreak>, Dedented>>);
@@ -58,7 +62,7 @@ RULE(FunctionDeclaration, ParseRule<
    >, SynchronizeOnToken<TokenType::Linebreak>, build_function_decleration>);
 
 RULE(FunctionDefinition, ParseRule<
-   Sequence<FunctionDeclaration, CodeBlock>, SynchronizeOnToken<TokenType::Indent>, build_func_definition>);
+   Sequence<FunctionDeclaration, Deferred<CodeBlock, build_deferred_block_node>>, SynchronizeOnToken<TokenType::Indent>, build_func_definition>);
 
 RULE(TupleValues, ParseRule <
    RepeatsWithSeperator<Value, TokenType::Seperator>,
@@ -73,9 +77,27 @@ RULE(FunctionArgumentsScope, ParseRule <
 RULE(FunctionCall, ParseRule<
    Sequence<Value, FunctionArgumentsScope>, NeverSynchroize, build_function_call_node>);
 
-RULE(Expression, ParseRule<AnyOf<
+constexpr std::array OPERATORS{
+   OperatorDefinition{ u8"-", Fixity::Prefix, 10 },
+   OperatorDefinition{ u8"!", Fixity::Prefix, 10 },
+   OperatorDefinition{ u8"~", Fixity::Prefix, 10 },
+   OperatorDefinition{ u8"*", Fixity::Infix, 9 },
+   OperatorDefinition{ u8"/", Fixity::Infix, 9 },
+   OperatorDefinition{ u8"+", Fixity::Infix, 8 },
+   OperatorDefinition{ u8"-", Fixity::Infix, 8 },
+   OperatorDefinition{ u8"<<", Fixity::Infix, 7 },
+   OperatorDefinition{ u8">>", Fixity::Infix, 7 },
+   OperatorDefinition{ u8"<", Fixity::Infix, 6 },
+   OperatorDefinition{ u8">", Fixity::Infix, 6 },
+   OperatorDefinition{ u8"&", Fixity::Infix, 5 },
+   OperatorDefinition{ u8"|", Fixity::Infix, 4 },
+   OperatorDefinition{ u8"&&", Fixity::Infix, 3 },
+   OperatorDefinition{ u8"||", Fixity::Infix, 2 },
+};
+
+RULE(Expression, ParseRule<PrecedenceExpression<AnyOf<
    Value,
-   FunctionCall>
+   FunctionCall>, OPERATORS>
    , NeverSynchroize, build_expression_node>);
 
 RULE(Assignment,
@@ -104,5 +126,10 @@ RULE(CodeBlock, ParseRule<
    EndBlock
    >, SynchronzieOnMatchedPair<TokenType::Indent, TokenType::Indent>, build_block_node>);
 
+//! A single line of the top level block, the unit a module is split into when parsing it in parallel
+export RULE(TopLevelStatement, Sequence<NewBlock, Statement, EndOfLine>);
+//! Ends the top level block after its last statement
+export RULE(TopLevelEnd, EndBlock);
+
 export RULE(AlumiGrammar, ParseRule<AnyOf<EndOfLine, CodeBlock>, SynchronizeOnToken<TokenType::Linebreak>, build_root_node>);
 }
\ No newline at end of file
@@ -14,7 +14,7 @@ import alumi.syntax_tree.node_builder;
 using namespace alumi;
 
 
-std::optional<Node> build_root_node(const Result& res)
+export std::optional<Node> build_root_node(const Result& res)
 {
    if (res.get_type() == Result::Type::Failure)
    {
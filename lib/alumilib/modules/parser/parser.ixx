@@ -1,5 +1,6 @@
 export module alumi.parser;
 
+export import alumi.parser.context;
 export import alumi.parser.error_codes;
 export import alumi.parser.result;
 export import alumi.parser.subparser;
\ No newline at end of file
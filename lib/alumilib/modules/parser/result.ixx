@@ -4,6 +4,7 @@ module;
 
 export module alumi.parser.result;
 
+import alumi.parser.context;
 import alumi.parser.subparser;
 import alumi.syntax_tree.nodes;
 
@@ -15,16 +16,11 @@ namespace alumi::parser {
 export class Result
 {
 public:
-   enum class Type
-   {
-      Failure,
-      RecoveredFailure,
-      Success
-   };
+   using Type = ResultType;
 
    Result(Type type,
           const Subparser& parser,
-          const Nodes& parsed_nodes)
+          NodeRange parsed_nodes)
       : m_type(type)
       , m_parser_used(parser)
       , m_nodes(parsed_nodes)
@@ -55,7 +51,15 @@ public:
       return m_parser_used.get_panic_token_index();
    }
 
-   const Nodes& get_nodes() const
+   //!
+   //! The nodes produced, only valid until the node buffer is rolled back past them
+   //! 
+   NodeSpan get_nodes() const
+   {
+      return m_parser_used.context().nodes().view(m_nodes);
+   }
+
+   NodeRange get_node_range() const
    {
       return m_nodes;
    }
@@ -65,7 +69,7 @@ private:
 
    Subparser m_parser_used;
 
-   Nodes m_nodes;
+   NodeRange m_nodes;
 
 };
 
@@ -2,24 +2,36 @@ module;
 
 #include "alumi/lexer/token.h"
 
+#include <span>
 #include <vector>
 #include <optional>
 
 export module alumi.parser.subparser;
 
+import alumi.parser.context;
+
 using namespace alumi;
 
 //!
 //! Represents a parsing view of a single token stream
 //! 
+//! Children are created for every attempt at a sub-expression, so the state is kept small enough
+//! that copying it never allocates: the indent stack lives in the shared ParseContext and
+//! swallowed tokens are a bitmask, with skip links over them shared through the context
 //! 
 export class Subparser
 {
 public:
-   Subparser(const std::vector<Token>& tokens)
+   //! The context is shared by every subparser of one parse, so it has to be handed in. It is not owned,
+   //! whoever runs the parse keeps it alive for as long as the subparsers and their results
+   Subparser(const std::vector<Token>& tokens, ParseContext& context, size_t start = 0)
       : m_token_source(&tokens)
-      , m_start(0)
-      , m_current(0)
+      , m_context(&context)
+      , m_token_types(context.token_types(tokens).data())
+      , m_indent_stack(IndentStacks::EMPTY)
+      , m_start(start)
+      , m_current(start)
+      , m_skip_links(nullptr)
       , m_panic_token_index()
    {
    }
@@ -36,71 +48,91 @@ public:
       return *m_token_source;
    }
 
+   //! The types of tokens(), packed
+   std::span<const TokenType> token_types() const
+   {
+      return std::span<const TokenType>(m_token_types, m_token_source->size());
+   }
+
    //!
    //! Gets next token and advances internal token index by 1
    //! If past then end of the token stream, instead returns the last token
    //! 
-   Token advance()
+   const Token& advance()
    {
-      do
+      size_t index = next_visible(m_current);
+      if (index >= m_token_source->size())
       {
-         if (m_current >= m_token_source->size())
-         {
-            return m_token_source->back();
-         }
-         auto& cur = (*m_token_source)[m_current++];
-         if (std::find(m_swallowed.begin(), m_swallowed.end(), cur.type()) == m_swallowed.end())
-         {
-            if (cur.type() == TokenType::Indent)
-            {
-               if (m_indent_stack.size() > 0 && m_indent_stack.back() > cur.size())
-               {
-                  m_indent_stack.pop_back();
-               }
-               if (m_indent_stack.size() == 0 || m_indent_stack.back() < cur.size())
-               {
-                  m_indent_stack.push_back(cur.size());
-               }
-            }
-            return cur;
-         }
+         m_current = m_token_source->size();
+         return m_token_source->back();
+      }
 
-      } while (true);
+      m_current = index + 1;
+      const Token& cur = (*m_token_source)[index];
+      if (m_token_types[index] == TokenType::Indent)
+      {
+         track_indent(cur);
+      }
+      return cur;
+   }
 
-      throw std::exception(); // TOOD better error reporting, as this must mean ignoring EOF?
+   //!
+   //! Advances past the token at index, updating the indention as advancing token by token would
+   //! 
+   void advance_past(size_t index)
+   {
+      if (!m_swallowed.contains(TokenType::Indent))
+      {
+         for (uint32_t indent : m_context->token_index().indents_between(token_types(), m_current, index + 1))
+         {
+            track_indent((*m_token_source)[indent]);
+         }
+      }
+      m_current = index + 1;
    }
 
    //!
    //! Returns the next token
    //! If past the end of the token stream, instead returns the last token
    //! 
-   Token peek() const
+   const Token& peek() const
    {
-      if (m_current >= m_token_source->size())
+      size_t index = next_visible(m_current);
+      if (index >= m_token_source->size())
       {
          return m_token_source->back();
       }
+      return (*m_token_source)[index];
+   }
 
-      size_t offset = 0;
-      do
+   //!
+   //! Returns the type of the next token, without loading the token itself
+   //! If past then end of the token stream, instead returns the type of the last token
+   //! 
+   TokenType peek_type() const
+   {
+      size_t index = next_visible(m_current);
+      if (index >= m_token_source->size())
       {
-         auto& cur = (*m_token_source)[m_current + offset];
-         offset += 1;
-         if (std::find(m_swallowed.begin(), m_swallowed.end(), cur.type()) == m_swallowed.end())
-         {
-            return cur;
-         }
-      } while (true);
+         return m_token_types[m_token_source->size() - 1];
+      }
+      return m_token_types[index];
+   }
 
-      throw std::exception(); // TOOD better error reporting, as this must mean ignoring EOF?
+   //!
+   //! The context of the parse this is part of, shared with every parent and child
+   //! 
+   ParseContext& context() const
+   {
+      return *m_context;
    }
 
-   Token start_token() const
+   const Token& start_token() const
    {
       return (*m_token_source)[m_start];
    }
 
-   Token current_token() const
+   const Token& current_token() const
    {
       if (m_current < m_token_source->size())
       {
@@ -140,6 +172,21 @@ public:
       m_panic_token_index = parser.m_panic_token_index;
    }
 
+   ParserState state() const
+   {
+      return ParserState{ m_start, m_current, m_indent_stack, m_swallowed, m_panic_token_index };
+   }
+
+   //!
+   //! Resumes from a state this parser was previously in, as in take_over_from
+   //! 
+   void resume_from(const ParserState& state)
+   {
+      m_indent_stack = state.indent_stack;
+      m_current = state.current;
+      m_panic_token_index = state.panic_token_index;
+   }
+
    size_t get_distance() const
    {
       return m_current - m_start;
@@ -147,11 +194,7 @@ public:
 
    std::optional<size_t> get_indent() const
    {
-      if (m_indent_stack.empty())
-      {
-         return std::nullopt;
-      }
-      return m_indent_stack.back();
+      return m_context->indent_stacks().top(m_indent_stack);
    }
 
    // TODO Consider how to handle panicing, note that RECOVERED ERRORS paniced because a subparser paniced and not themselves
@@ -162,7 +205,13 @@ public:
    //! 
    void add_swallowed_token(TokenType type)
    {
-      m_swallowed.push_back(type);
+      m_swallowed.insert(type);
+      m_skip_links = &m_context->skip_links().links_for(token_types(), m_swallowed);
+   }
+
+   bool is_swallowed(TokenType type) const
+   {
+      return m_swallowed.contains(type);
    }
 
    //!
@@ -201,12 +250,44 @@ public:
    }
 
 private:
+   //!
+   //! The index of the first token at or after index that is not swallowed
+   //! 
+   size_t next_visible(size_t index) const
+   {
+      if (m_skip_links == nullptr || index >= m_token_source->size())
+      {
+         return index;
+      }
+      return (*m_skip_links)[index];
+   }
+
+   void track_indent(const Token& indent)
+   {
+      IndentStacks& stacks = m_context->indent_stacks();
+      auto top = stacks.top(m_indent_stack);
+      if (top.has_value() && *top > indent.size())
+      {
+         m_indent_stack = stacks.pop(m_indent_stack);
+         top = stacks.top(m_indent_stack);
+      }
+      if (!top.has_value() || *top < indent.size())
+      {
+         m_indent_stack = stacks.push(m_indent_stack, indent.size());
+      }
+   }
+
    const std::vector<Token>* m_token_source;
-   std::vector<size_t> m_indent_stack;
+   ParseContext* m_context;
+   // Types of the tokens in m_token_source, owned by the context
+   const TokenType* m_token_types;
+   IndentStacks::Id m_indent_stack;
 
    size_t m_start;
    size_t m_current;
-   std::vector<TokenType> m_swallowed;
+   TokenTypeSet m_swallowed;
+   // Null while nothing is swallowed
+   const SkipLinks::Links* m_skip_links;
 
    std::optional<size_t> m_panic_token_index;
 
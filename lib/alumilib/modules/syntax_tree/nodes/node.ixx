@@ -2,6 +2,9 @@ module;
 #include "alumi/lexer/token.h"
 #include "alumi/syntax_tree/node_children.h"
 
+#include <cstddef>
+#include <span>
+#include <stdexcept>
 #include <variant>
 
 export module alumi.syntax_tree.nodes.node;
@@ -31,7 +34,10 @@ export
 			FunctionDecleration,
 			FunctionDefinition,
 			FunctionCall,
-			Brancher>;
+			Brancher,
+			DeferredBlock,
+			UnaryOperation,
+			BinaryOperation>;
 
 		Node(const Type& node, size_t m_token_start, size_t m_token_end)
 			: m_actual(node)
@@ -46,6 +52,19 @@ export
 			return { m_token_start, m_token_end };
 		}
 
+		//! 
+		//! Moves every token index the node holds by offset, for reusing it after tokens before it were edited
+		//! 
+		void shift_tokens(std::ptrdiff_t offset)
+		{
+			m_token_start += offset;
+			m_token_end += offset;
+			if (Error* error = std::get_if<Error>(&m_actual))
+			{
+				error->token_index += offset;
+			}
+		}
+
 		//! 
 		//! Returns the total number nodes this group takes up, including itself and any children
 		//! 
@@ -89,6 +108,16 @@ export
 			return std::visit(visitor, m_actual);
 		}
 
+		//! 
+		//! Grows the child group holding the descendant offset nodes after this one by nodes,
+		//! for when that descendant was replaced by a larger subtree
+		//! 
+		void grow_child_group_at(size_t offset, std::ptrdiff_t nodes)
+		{
+			OpGrowChildGroupAt op(offset, nodes);
+			visit(op);
+		}
+
 		template<typename T>
 		bool is() const
 		{
@@ -111,4 +140,22 @@ export
 	};
 
 	using Nodes = std::vector<Node>;
+
+	//!
+	//! A view of consecutive nodes, such as the nodes a parse result produced
+	//! 
+	class NodeSpan : public std::span<const Node>
+	{
+	public:
+		using std::span<const Node>::span;
+
+		const Node& at(size_t index) const
+		{
+			if (index >= size())
+			{
+				throw std::out_of_range("NodeSpan index out of range");
+			}
+			return (*this)[index];
+		}
+	};
 }
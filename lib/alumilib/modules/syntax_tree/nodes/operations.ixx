@@ -1,6 +1,8 @@
 module;
 
 #include "alumi/syntax_tree/node_children.h"
+#include <cstddef>
+#include <stdexcept>
 #include <variant>
 
 export module alumi.syntax_tree.nodes.operations;
@@ -73,3 +75,31 @@ public:
 private:
 	size_t m_index;
 };
+
+export class OpGrowChildGroupAt
+{
+public:
+	OpGrowChildGroupAt(size_t offset, std::ptrdiff_t nodes)
+		: m_offset(offset)
+		, m_nodes(nodes)
+	{
+
+	}
+
+	template <typename T> requires requires (T& t) { t.groups; }
+	void operator()(T& obj) const
+	{
+		obj.groups.grow_group_at(m_offset, m_nodes);
+	}
+
+	//! A node without child groups has no descendants that could have been replaced
+	template <typename T>
+	void operator()(T& obj) const
+	{
+		throw std::out_of_range("Growing a child group of a node that has none");
+	}
+
+private:
+	size_t m_offset;
+	std::ptrdiff_t m_nodes;
+};
\ No newline at end of file
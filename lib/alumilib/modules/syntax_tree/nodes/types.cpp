@@ -1,6 +1,8 @@
 #include "alumi/lexer/token.h"
 #include "alumi/syntax_tree/node_children.h"
 
+#include <span>
+#include <string_view>
 #include <variant>
 #include <optional>
 
@@ -13,7 +15,7 @@ using namespace alumi;
 using namespace alumi::syntax_tree;
 
 
-Error::Error(ErrorCode ec, size_t token_index, const Nodes& children)
+Error::Error(ErrorCode ec, size_t token_index, std::span<const Node> children)
 	: groups({ ChildGroup(1, children.size()) })
 	, error_code(ec)
 	, token_index(token_index)
@@ -21,13 +23,13 @@ Error::Error(ErrorCode ec, size_t token_index, const Nodes& children)
 
 }
 
-ModuleRoot::ModuleRoot(const Nodes& children)
+ModuleRoot::ModuleRoot(std::span<const Node> children)
 	: groups({ ChildGroup(1, children.size()) })
 {
 
 }
 
-CodeBlock::CodeBlock(const Nodes& children)
+CodeBlock::CodeBlock(std::span<const Node> children)
 	: groups({ ChildGroup(1, children.size()) })
 {
 
@@ -39,7 +41,7 @@ Assignment::Assignment(const Node& value)
 
 }
 
-Statement::Statement(const Nodes& children)
+Statement::Statement(std::span<const Node> children)
 	: groups({ ChildGroup(1, children.size()) })
 {
 
@@ -58,3 +60,17 @@ FunctionDefinition::FunctionDefinition(const Node& decleration, const Node& code
 {
 
 }
+
+UnaryOperation::UnaryOperation(std::u8string_view op, size_t operand_node_count)
+	: groups({ ChildGroup(1, operand_node_count) })
+	, op(op)
+{
+
+}
+
+BinaryOperation::BinaryOperation(std::u8string_view op, size_t lhs_node_count, size_t rhs_node_count)
+	: groups({ ChildGroup(1, lhs_node_count), ChildGroup(1 + lhs_node_count, rhs_node_count) })
+	, op(op)
+{
+
+}
@@ -2,6 +2,8 @@ module;
 #include "alumi/lexer/token.h"
 #include "alumi/syntax_tree/node_children.h"
 
+#include <span>
+#include <string_view>
 #include <variant>
 #include <optional>
 
@@ -21,7 +23,7 @@ export
 	class Error
 	{
 	public:
-		Error(ErrorCode ec, size_t token_index, const Nodes& children);
+		Error(ErrorCode ec, size_t token_index, std::span<const Node> children);
 
 
 		ChildGroups<1> groups;
@@ -33,7 +35,7 @@ export
 	class ModuleRoot
 	{
 	public:
-		ModuleRoot(const Nodes& children);
+		ModuleRoot(std::span<const Node> children);
 
 		ChildGroups<1> groups;
 	};
@@ -41,7 +43,7 @@ export
 	class CodeBlock
 	{
 	public:
-		CodeBlock(const Nodes& children);
+		CodeBlock(std::span<const Node> children);
 
 		ChildGroups<1> groups;
 	};
@@ -64,7 +66,7 @@ export
 	class Statement
 	{
 	public:
-		Statement(const Nodes& children);
+		Statement(std::span<const Node> children);
 
 		ChildGroups<1> groups;
 	private:
@@ -106,4 +108,37 @@ export
 	private:
 	};
 
+	//!
+	//! An operator applied to a single operand, before or after it
+	//! 
+	class UnaryOperation
+	{
+	public:
+		UnaryOperation(std::u8string_view op, size_t operand_node_count);
+
+		ChildGroups<1> groups;
+		std::u8string_view op;
+	};
+
+	//!
+	//! An operator applied to the operands on either side of it
+	//! 
+	class BinaryOperation
+	{
+	public:
+		BinaryOperation(std::u8string_view op, size_t lhs_node_count, size_t rhs_node_count);
+
+		ChildGroups<2> groups;
+		std::u8string_view op;
+	};
+
+	//!
+	//! An indented block that was skimmed instead of parsed, spanning its tokens so that it can be parsed later
+	//! 
+	class DeferredBlock
+	{
+	public:
+	private:
+	};
+
 }
@@ -2,13 +2,25 @@
 
 namespace alumi
 {
-   LexedText::LexedText(const std::vector<UnicodeCodePoint>& text, const Tokens& tokens)
-      : m_text(text)
-      , m_tokens(tokens)   {
-
+   LexedText::LexedText(std::u8string text, const Tokens& tokens, LiteralTable literals, SymbolTable symbols)
+      : m_text(std::move(text))
+      , m_tokens(tokens)
+      , m_literals(std::move(literals))
+      , m_symbols(std::move(symbols))
+   {
+      m_symbols.cover(m_tokens.size());
+      m_types.reserve(m_tokens.size());
+      m_offsets.reserve(m_tokens.size());
+      m_sizes.reserve(m_tokens.size());
+      for (const Token& token : m_tokens)
+      {
+         m_types.push_back(token.type());
+         m_offsets.push_back(static_cast<uint32_t>(token.pos().byte_index()));
+         m_sizes.push_back(static_cast<uint32_t>(token.size()));
+      }
    }
 
-   const std::vector<UnicodeCodePoint>& LexedText::text() const
+   std::u8string_view LexedText::text() const
    {
       return m_text;
    }
@@ -17,4 +29,29 @@ namespace alumi
    {
       return m_tokens;
    }
+
+   TokenColumns LexedText::columns() const
+   {
+      return TokenColumns{ m_types, m_offsets, m_sizes, m_symbols.ids() };
+   }
+
+   std::u8string_view LexedText::token_text(const Token& token) const
+   {
+      return text().substr(token.pos().byte_index(), token.size());
+   }
+
+   std::u8string_view LexedText::token_text(size_t token_index) const
+   {
+      return token_text(m_tokens[token_index]);
+   }
+
+   const LiteralTable& LexedText::literals() const
+   {
+      return m_literals;
+   }
+
+   const SymbolTable& LexedText::symbols() const
+   {
+      return m_symbols;
+   }
 }
@@ -0,0 +1,142 @@
+#include "alumi/lexer/literal_table.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+
+namespace alumi
+{
+   LiteralValue::LiteralValue(Kind kind, bool overflowed)
+      : m_integer(0)
+      , m_kind(kind)
+      , m_overflowed(overflowed)
+   {
+
+   }
+
+   LiteralValue LiteralValue::integer(int64_t value)
+   {
+      LiteralValue literal(Kind::Integer, false);
+      literal.m_integer = value;
+      return literal;
+   }
+
+   LiteralValue LiteralValue::floating(double value, bool overflowed)
+   {
+      LiteralValue literal(Kind::Float, overflowed);
+      literal.m_float = value;
+      return literal;
+   }
+
+   LiteralValue::Kind LiteralValue::kind() const
+   {
+      return m_kind;
+   }
+
+   int64_t LiteralValue::as_integer() const
+   {
+      assert(m_kind == Kind::Integer);
+      return m_integer;
+   }
+
+   double LiteralValue::as_float() const
+   {
+      if (m_kind == Kind::Integer)
+      {
+         return static_cast<double>(m_integer);
+      }
+      return m_float;
+   }
+
+   bool LiteralValue::overflowed() const
+   {
+      return m_overflowed;
+   }
+
+   bool LiteralValue::operator==(const LiteralValue& r) const
+   {
+      if (m_kind != r.m_kind || m_overflowed != r.m_overflowed)
+      {
+         return false;
+      }
+      if (m_kind == Kind::Integer)
+      {
+         return m_integer == r.m_integer;
+      }
+      return m_float == r.m_float;
+   }
+
+   std::optional<LiteralValue> parse_literal(std::u8string_view text)
+   {
+      // Literals are plain ASCII, so the bytes can be handed to from_chars as they are
+      const char* begin = reinterpret_cast<const char*>(text.data());
+      const char* end = begin + text.size();
+
+      bool is_float = std::any_of(begin, end, [](char c) { return c == '.' || c == 'e' || c == 'E'; });
+
+      if (!is_float)
+      {
+         int64_t value = 0;
+         auto [ptr, ec] = std::from_chars(begin, end, value);
+         if (ec == std::errc() && ptr == end)
+         {
+            return LiteralValue::integer(value);
+         }
+         if (ec != std::errc::result_out_of_range)
+         {
+            return std::nullopt;
+         }
+      }
+
+      double value = 0.0;
+      auto [ptr, ec] = std::from_chars(begin, end, value);
+      if (ptr != end)
+      {
+         return std::nullopt;
+      }
+      if (ec == std::errc::result_out_of_range)
+      {
+         // from_chars leaves the value alone when out of range, strtod
+         // saturates to infinity or zero the way the literal asks for
+         return LiteralValue::floating(std::strtod(std::string(begin, end).c_str(), nullptr), true);
+      }
+      if (ec != std::errc())
+      {
+         return std::nullopt;
+      }
+      return LiteralValue::floating(value, !is_float);
+   }
+
+   void LiteralTable::add(size_t token_index, const LiteralValue& value)
+   {
+      assert(m_token_indices.empty() || m_token_indices.back() < token_index);
+      m_token_indices.push_back(static_cast<uint32_t>(token_index));
+      m_values.push_back(value);
+      if (value.overflowed())
+      {
+         m_overflow_count += 1;
+      }
+   }
+
+   std::optional<LiteralValue> LiteralTable::find(size_t token_index) const
+   {
+      auto ite = std::lower_bound(m_token_indices.begin(), m_token_indices.end(), token_index);
+      if (ite != m_token_indices.end() && *ite == token_index)
+      {
+         return m_values[ite - m_token_indices.begin()];
+      }
+      return std::nullopt;
+   }
+
+   size_t LiteralTable::size() const
+   {
+      return m_values.size();
+   }
+
+   size_t LiteralTable::overflow_count() const
+   {
+      return m_overflow_count;
+   }
+}
@@ -0,0 +1,97 @@
+#include "alumi/lexer/symbol_table.h"
+
+#include <cassert>
+
+namespace alumi
+{
+   SymbolTable::SymbolTable(const SymbolTable& other)
+      : m_ids(other.m_ids)
+      , m_spellings(other.m_spellings)
+   {
+      reindex();
+   }
+
+   SymbolTable& SymbolTable::operator=(const SymbolTable& other)
+   {
+      if (this != &other)
+      {
+         m_ids = other.m_ids;
+         m_spellings = other.m_spellings;
+         reindex();
+      }
+      return *this;
+   }
+
+   SymbolId SymbolTable::add(size_t token_index, std::u8string_view spelling)
+   {
+      assert(m_ids.size() <= token_index);
+
+      SymbolId id;
+      auto ite = m_index.find(spelling);
+      if (ite != m_index.end())
+      {
+         id = ite->second;
+      }
+      else
+      {
+         id = static_cast<SymbolId>(m_spellings.size());
+         const auto& stored = m_spellings.emplace_back(spelling);
+         m_index.emplace(stored, id);
+      }
+
+      m_ids.resize(token_index, NO_SYMBOL);
+      m_ids.push_back(id);
+      return id;
+   }
+
+   void SymbolTable::cover(size_t token_count)
+   {
+      if (m_ids.size() < token_count)
+      {
+         m_ids.resize(token_count, NO_SYMBOL);
+      }
+   }
+
+   std::optional<SymbolId> SymbolTable::find(size_t token_index) const
+   {
+      if (token_index < m_ids.size() && m_ids[token_index] != NO_SYMBOL)
+      {
+         return m_ids[token_index];
+      }
+      return std::nullopt;
+   }
+
+   std::span<const SymbolId> SymbolTable::ids() const
+   {
+      return m_ids;
+   }
+
+   std::optional<SymbolId> SymbolTable::find_spelling(std::u8string_view spelling) const
+   {
+      auto ite = m_index.find(spelling);
+      if (ite != m_index.end())
+      {
+         return ite->second;
+      }
+      return std::nullopt;
+   }
+
+   std::u8string_view SymbolTable::spelling(SymbolId id) const
+   {
+      return m_spellings.at(id);
+   }
+
+   size_t SymbolTable::size() const
+   {
+      return m_spellings.size();
+   }
+
+   void SymbolTable::reindex()
+   {
+      m_index.clear();
+      for (size_t i = 0; i < m_spellings.size(); ++i)
+      {
+         m_index.emplace(m_spellings[i], static_cast<SymbolId>(i));
+      }
+   }
+}
@@ -0,0 +1,68 @@
+#include "alumi/lexer/token_ring.h"
+
+#include <algorithm>
+
+namespace alumi
+{
+   TokenRing::TokenRing(size_t capacity)
+      : m_slots(capacity, Token(TokenType::EndOfFile, TextPos(0, 0, 0), 0))
+      , m_head(0)
+      , m_tail(0)
+   {
+
+   }
+
+   void TokenRing::push(std::span<const Token> tokens)
+   {
+      size_t tail = m_tail.load(std::memory_order_relaxed);
+      while (!tokens.empty())
+      {
+         size_t head = m_head.load(std::memory_order_acquire);
+         if (tail - head == m_slots.size())
+         {
+            m_head.wait(head, std::memory_order_acquire);
+            continue;
+         }
+
+         size_t count = std::min(tokens.size(), m_slots.size() - (tail - head));
+         for (size_t index = 0; index < count; ++index)
+         {
+            m_slots[(tail + index) % m_slots.size()] = tokens[index];
+         }
+         tail += count;
+         tokens = tokens.subspan(count);
+         m_tail.store(tail, std::memory_order_release);
+         m_tail.notify_one();
+      }
+   }
+
+   void TokenRing::close()
+   {
+      m_tail.fetch_or(CLOSED, std::memory_order_release);
+      m_tail.notify_one();
+   }
+
+   bool TokenRing::pop_available(Tokens& out)
+   {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      size_t tail = m_tail.load(std::memory_order_acquire);
+      while ((tail & ~CLOSED) == head)
+      {
+         if (tail & CLOSED)
+         {
+            return false;
+         }
+         m_tail.wait(tail, std::memory_order_acquire);
+         tail = m_tail.load(std::memory_order_acquire);
+      }
+
+      tail &= ~CLOSED;
+      for (; head != tail; ++head)
+      {
+         out.push_back(m_slots[head % m_slots.size()]);
+      }
+      m_head.store(head, std::memory_order_release);
+      m_head.notify_one();
+      return true;
+   }
+}
@@ -1,6 +1,13 @@
 #include "alumi/parser.h"
 
+#include <algorithm>
+#include <cassert>
+#include <future>
+#include <optional>
+#include <span>
+#include <vector>
 
+import alumi.parser.error_codes;
 import alumi.parser.grammar;
 
 
@@ -8,7 +15,144 @@ namespace alumi
 {
    namespace parser
    {
-      AlumiParser::AlumiParser()
+      namespace
+      {
+         //!
+         //! The token indices of every line that starts at column zero, each of which starts a top level statement
+         //! 
+         std::vector<size_t> top_level_starts(const Tokens& tokens, size_t from = 0)
+         {
+            std::vector<size_t> starts;
+            for (size_t index = from; index < tokens.size(); ++index)
+            {
+               bool line_start = index == 0 || tokens[index - 1].type() == TokenType::Linebreak;
+               if (line_start && tokens[index].type() == TokenType::Indent && tokens[index].size() == 0)
+               {
+                  starts.push_back(index);
+               }
+            }
+            return starts;
+         }
+
+         //!
+         //! The nodes of a run of top level statements, and where the last of them ended
+         //! 
+         struct ParsedStatements
+         {
+            Nodes nodes;
+            size_t end = 0;
+         };
+
+         //!
+         //! Parses the top level statements from starts[first] up to starts[last], or to the end of the
+         //! module if last is past the final statement. Returns nullopt unless every statement succeeds
+         //! and ends exactly where the next one starts, as only then the sequential parse would be the same.
+         //! The context may be one that parsed statements before, its nodes are copied out and dropped
+         //! 
+         std::optional<ParsedStatements> parse_statements(const Tokens& tokens, ParseContext& context,
+                                                          const std::vector<size_t>& starts, size_t first, size_t last)
+         {
+            NodeBuffer& nodes = context.nodes();
+            ParsedStatements parsed;
+            for (size_t index = first; index < last; ++index)
+            {
+               size_t node_mark = nodes.mark();
+               Subparser statement_parser(tokens, context, starts[index]);
+               Result res = grammar::TopLevelStatement::parse(statement_parser);
+               if (res.get_type() != Result::Type::Success)
+               {
+                  return std::nullopt;
+               }
+               NodeSpan statement = nodes.view(nodes.compact(res.get_node_range()));
+               parsed.nodes.insert(parsed.nodes.end(), statement.begin(), statement.end());
+               nodes.rollback(node_mark);
+
+               if (index + 1 < starts.size())
+               {
+                  if (statement_parser.current_token_index() != starts[index + 1])
+                  {
+                     return std::nullopt;
+                  }
+               }
+               else if (grammar::TopLevelEnd::parse(statement_parser).get_type() != Result::Type::Success)
+               {
+                  return std::nullopt;
+               }
+               parsed.end = statement_parser.current_token_index();
+            }
+            return parsed;
+         }
+
+         //!
+         //! As above, in a context of its own. The token types are built from the tokens if empty
+         //! 
+         std::optional<ParsedStatements> parse_statements(const Tokens& tokens, std::u8string_view source, std::span<const TokenType> token_types,
+                                                          const std::vector<size_t>& starts, size_t first, size_t last, ParseOptions options)
+         {
+            ParseContext context(options, source, token_types);
+            return parse_statements(tokens, context, starts, first, last);
+         }
+
+         //!
+         //! The tree of a module that parsed without errors, with the nodes of its top level statements
+         //! 
+         SyntaxTree module_tree(const LexedText& text, ParseOptions options, const Nodes& statements, size_t end)
+         {
+            auto context = std::make_shared<ParseContext>(options, text.text(), text.columns().types);
+            NodeBuffer& nodes = context->nodes();
+            Subparser root_parser(text.tokens(), *context);
+            root_parser.advance_past(end - 1);
+
+            // Built as the serial parse would once the block and the root have parsed everything up to the end
+            size_t root_slot = nodes.reserve_slot();
+            size_t block_slot = nodes.reserve_slot();
+            nodes.append(NodeSpan(statements));
+            nodes.fill_slot(block_slot, *build_block_node(Result(Result::Type::Success, root_parser, nodes.since(block_slot + 1))));
+            nodes.fill_slot(root_slot, *build_root_node(Result(Result::Type::Success, root_parser, nodes.since(block_slot))));
+            return SyntaxTree(Result(Result::Type::Success, root_parser, nodes.since(root_slot)), &text, context);
+         }
+
+         //!
+         //! The tree of a parse that started with a rule that builds its node with builder, in the given context. Once a
+         //! parse stops the rules skip their builders, so the nodes of a stopped parse are put under the node of builder only here
+         //! 
+         SyntaxTree parsed_tree(const Result& res, const LexedText& text, std::optional<Node>(*builder)(const Result&), std::shared_ptr<ParseContext> context)
+         {
+            if (!context->is_stopped())
+            {
+               return SyntaxTree(res, &text, std::move(context));
+            }
+
+            NodeBuffer& nodes = context->nodes();
+            Result stopped(res.get_type(), res.get_subparser(), nodes.compact(res.get_node_range()));
+            NodeSpan children = nodes.view(stopped.get_node_range());
+            Nodes tree_nodes{ *builder(stopped) };
+            tree_nodes.insert(tree_nodes.end(), children.begin(), children.end());
+
+            SyntaxTree tree(stopped, &text, std::move(context));
+            tree.nodes() = std::move(tree_nodes);
+            return tree;
+         }
+
+         //! Statements parsed at a time while lexing, so the parse does not stop for every single line
+         constexpr size_t STATEMENTS_PER_RUN = 64;
+
+         //!
+         //! The index of a token index in starts, or nullopt if it is not in it
+         //! 
+         std::optional<size_t> find_start(const std::vector<size_t>& starts, size_t token_index)
+         {
+            auto ite = std::lower_bound(starts.begin(), starts.end(), token_index);
+            if (ite == starts.end() || *ite != token_index)
+            {
+               return std::nullopt;
+            }
+            return ite - starts.begin();
+         }
+      }
+
+      AlumiParser::AlumiParser(ParseOptions options)
+         : m_options(options)
       {
 
       }
@@ -19,8 +163,291 @@ namespace alumi
 
       SyntaxTree AlumiParser::parse(const LexedText& text) const
       {
-         Subparser root_parser(text.tokens());
-         return SyntaxTree(grammar::AlumiGrammar::parse(root_parser), &text);
+         if (m_options.iterative)
+         {
+            return parse_iterative(text);
+         }
+         if (m_options.threads > 1)
+         {
+            if (auto tree = parse_parallel(text); tree.has_value())
+            {
+               return *tree;
+            }
+         }
+
+         auto context = std::make_shared<ParseContext>(m_options, text.text(), text.columns().types);
+         Subparser root_parser(text.tokens(), *context);
+         Result res = grammar::AlumiGrammar::parse(root_parser);
+         return parsed_tree(res, text, build_root_node, std::move(context));
+      }
+
+      SyntaxTree AlumiParser::parse_deferred(const LexedText& text, const Node& deferred) const
+      {
+         return parse_deferred(text, deferred, std::make_shared<ParseContext>(m_options, text.text(), text.columns().types));
+      }
+
+      SyntaxTree AlumiParser::parse_deferred(const LexedText& text, const Node& deferred, std::shared_ptr<ParseContext> context) const
+      {
+         assert(deferred.is<DeferredBlock>());
+         auto [token_start, token_end] = deferred.spans_tokens();
+         Subparser block_parser(text.tokens(), *context, token_start);
+         Result res = grammar::CodeBlock::parse(block_parser);
+         return parsed_tree(res, text, build_block_node, std::move(context));
+      }
+
+      std::optional<SyntaxTree> AlumiParser::parse_parallel(const LexedText& text) const
+      {
+         const Tokens& tokens = text.tokens();
+         std::vector<size_t> starts = top_level_starts(tokens);
+         if (starts.size() < 2 || starts.front() != 0)
+         {
+            return std::nullopt;
+         }
+
+         // Each thread parses a consecutive run of statements, so that their nodes can simply be concatenated
+         size_t thread_count = std::min(m_options.threads, starts.size());
+         std::vector<std::future<std::optional<ParsedStatements>>> runs;
+         for (size_t thread = 0; thread < thread_count; ++thread)
+         {
+            size_t first = starts.size() * thread / thread_count;
+            size_t last = starts.size() * (thread + 1) / thread_count;
+            runs.push_back(std::async(std::launch::async, [&, first, last]()
+               {
+                  return parse_statements(tokens, text.text(), text.columns().types, starts, first, last, m_options);
+               }));
+         }
+
+         Nodes statements;
+         size_t end = 0;
+         bool all_parsed = true;
+         for (auto& run : runs)
+         {
+            auto parsed = run.get();
+            all_parsed = all_parsed && parsed.has_value();
+            if (parsed.has_value())
+            {
+               statements.insert(statements.end(), parsed->nodes.begin(), parsed->nodes.end());
+               end = parsed->end;
+            }
+         }
+         if (!all_parsed)
+         {
+            // Errors are left to the sequential parse, which knows how to recover from them
+            return std::nullopt;
+         }
+
+         return module_tree(text, m_options, statements, end);
+      }
+
+      SyntaxTree AlumiParser::parse_iterative(const LexedText& text) const
+      {
+         ParseOptions options = m_options;
+         options.iterative = false;
+         options.defer_blocks = true;
+         AlumiParser skimmer(options);
+         SyntaxTree skimmed = skimmer.parse(text);
+         Result::Type type = skimmed.parse_result().get_type();
+
+         // The nodes are copied over in order, with every DeferredBlock replaced by the nodes of its body. The
+         // bodies are parsed deferring their own blocks, so nesting only ever grows the explicit stacks
+         struct Source
+         {
+            Nodes nodes;
+            size_t next = 0;
+         };
+         std::vector<Source> sources;
+         sources.push_back(Source{ skimmed.nodes() });
+         // Every body is parsed in the same context, so its token index is built once for the whole text and the
+         // error limit applies to all the bodies together
+         auto body_context = std::make_shared<ParseContext>(options, text.text(), text.columns().types);
+         // Where the module ends, or where it fails if a body stops the parse
+         Subparser root_parser = skimmed.parse_result().get_subparser();
+         // Indices of the copied nodes whose subtrees are still being copied
+         std::vector<size_t> open;
+         Nodes nodes;
+         while (!sources.empty())
+         {
+            Source& source = sources.back();
+            if (source.next == source.nodes.size())
+            {
+               sources.pop_back();
+               continue;
+            }
+
+            while (!open.empty() && nodes.size() >= open.back() + nodes[open.back()].recursive_child_count())
+            {
+               open.pop_back();
+            }
+
+            const Node& node = source.nodes[source.next++];
+            // Once the parse stopped the bodies left are not parsed, as the recursive parse would not have either
+            if (node.is<DeferredBlock>() && !body_context->is_stopped())
+            {
+               SyntaxTree body = skimmer.parse_deferred(text, node, body_context);
+               Nodes body_nodes = body.nodes();
+               if (body.parse_result().get_type() == Result::Type::Failure)
+               {
+                  // A body that fails outright is spliced in all the same, with the Error node that reports it. Unless the
+                  // parse stopped on it, the code around it recovers from it as it does in the recursive parse
+                  if (body_context->is_stopped())
+                  {
+                     type = Result::Type::Failure;
+                     root_parser.do_panic(*body.parse_result().get_panic_token_index());
+                  }
+                  else
+                  {
+                     type = std::min(type, Result::Type::RecoveredFailure);
+                  }
+                  if (body_nodes.empty())
+                  {
+                     auto [token_start, token_end] = node.spans_tokens();
+                     body_nodes.push_back(Node(Error(ErrorCode::Unknown, token_start, {}), token_start, token_end));
+                  }
+               }
+               else
+               {
+                  type = std::min(type, body.parse_result().get_type());
+               }
+
+               std::ptrdiff_t growth = static_cast<std::ptrdiff_t>(body_nodes.size()) - 1;
+               for (size_t ancestor : open)
+               {
+                  nodes[ancestor].grow_child_group_at(nodes.size() - ancestor, growth);
+               }
+               sources.push_back(Source{ std::move(body_nodes) });
+               continue;
+            }
+
+            if (node.recursive_child_count() > 1)
+            {
+               open.push_back(nodes.size());
+            }
+            nodes.push_back(node);
+         }
+
+         SyntaxTree tree(Result(type, root_parser, skimmed.parse_result().get_node_range()), &text, skimmed.context());
+         tree.nodes() = std::move(nodes);
+         return tree;
+      }
+
+      ParsedText AlumiParser::parse_from_ring(TokenRing& ring, std::u8string_view source, std::future<LexedText>& lexed) const
+      {
+         // Statements are only parsed once the statement after them is complete, as that is as far as a statement may look
+         // ahead. Each batch of the ring ends right before a line at column zero, so that is every statement but the last
+         Tokens tokens;
+         std::vector<size_t> starts;
+         size_t scanned = 0;
+         // One context for the whole stream, which only ever looks at the tokens each run adds
+         ParseContext context(m_options, source);
+         ParsedStatements statements;
+         size_t parsed = 0;
+         bool streaming = !m_options.iterative;
+         while (ring.pop_available(tokens))
+         {
+            if (!streaming)
+            {
+               continue;
+            }
+
+            auto new_starts = top_level_starts(tokens, scanned);
+            starts.insert(starts.end(), new_starts.begin(), new_starts.end());
+            scanned = tokens.size();
+            if (starts.empty() || starts.front() != 0 || parsed + STATEMENTS_PER_RUN >= starts.size())
+            {
+               continue;
+            }
+
+            context.extend_tokens(tokens);
+            auto run = parse_statements(tokens, context, starts, parsed, starts.size() - 1);
+            if (!run.has_value())
+            {
+               // Errors are left to the sequential parse, the ring is still drained so the lexer can finish
+               streaming = false;
+               continue;
+            }
+            statements.nodes.insert(statements.nodes.end(), run->nodes.begin(), run->nodes.end());
+            statements.end = run->end;
+            parsed = starts.size() - 1;
+         }
+
+         auto text = std::make_unique<LexedText>(lexed.get());
+         if (streaming && !starts.empty() && starts.front() == 0)
+         {
+            auto run = parse_statements(text->tokens(), source, text->columns().types, starts, parsed, starts.size(), m_options);
+            if (run.has_value())
+            {
+               statements.nodes.insert(statements.nodes.end(), run->nodes.begin(), run->nodes.end());
+               SyntaxTree tree = module_tree(*text, m_options, statements.nodes, run->end);
+               return ParsedText{ std::move(text), std::move(tree) };
+            }
+         }
+
+         SyntaxTree tree = parse(*text);
+         return ParsedText{ std::move(text), std::move(tree) };
+      }
+
+      SyntaxTree AlumiParser::reparse(const SyntaxTree& previous, const LexedText& text, const TokenEdit& edit) const
+      {
+         const Nodes& old_nodes = previous.nodes();
+         // Errors recovered from still leave the tree a Success, so they are looked for among the nodes
+         if (previous.parse_result().get_type() != Result::Type::Success || old_nodes.size() < 2 ||
+             !old_nodes[0].is<ModuleRoot>() || !old_nodes[1].is<CodeBlock>() ||
+             std::any_of(old_nodes.begin(), old_nodes.end(), [](const Node& node) { return node.is<Error>(); }))
+         {
+            return parse(text);
+         }
+         size_t old_end = std::get<1>(old_nodes[0].spans_tokens());
+         std::ptrdiff_t shift = static_cast<std::ptrdiff_t>(edit.new_end) - static_cast<std::ptrdiff_t>(edit.old_end);
+
+         // Each statement starts right after the indent of its line, which is where its top level statement starts.
+         // Statements that end before the edit, with a token to spare for lookahead, are kept as they were, and
+         // statements that start after the edit are kept moved by the change in length
+         size_t kept_before = 2;
+         size_t reparse_from = 0;
+         size_t kept_after = old_nodes.size();
+         std::optional<size_t> reparse_to;
+         for (size_t index = 2; index < old_nodes.size(); index += old_nodes[index].recursive_child_count())
+         {
+            size_t next = index + old_nodes[index].recursive_child_count();
+            size_t statement_start = std::get<0>(old_nodes[index].spans_tokens()) - 1;
+            size_t statement_end = next < old_nodes.size() ? std::get<0>(old_nodes[next].spans_tokens()) - 1 : old_end;
+            if (statement_end < edit.start)
+            {
+               kept_before = next;
+               reparse_from = statement_end;
+            }
+            else if (statement_start > edit.old_end)
+            {
+               kept_after = index;
+               reparse_to = statement_start + shift;
+               break;
+            }
+         }
+
+         const Tokens& tokens = text.tokens();
+         std::vector<size_t> starts = top_level_starts(tokens);
+         auto first = find_start(starts, reparse_from);
+         auto last = reparse_to.has_value() ? find_start(starts, *reparse_to) : starts.size();
+         if (!first.has_value() || !last.has_value() || *first > *last || (*first == *last && !reparse_to.has_value()))
+         {
+            return parse(text);
+         }
+
+         auto parsed = parse_statements(tokens, text.text(), text.columns().types, starts, *first, *last, m_options);
+         if (!parsed.has_value())
+         {
+            return parse(text);
+         }
+
+         Nodes statements(old_nodes.begin() + 2, old_nodes.begin() + kept_before);
+         statements.insert(statements.end(), parsed->nodes.begin(), parsed->nodes.end());
+         for (size_t index = kept_after; index < old_nodes.size(); ++index)
+         {
+            statements.push_back(old_nodes[index]);
+            statements.back().shift_tokens(shift);
+         }
+         size_t end = reparse_to.has_value() ? old_end + shift : parsed->end;
+         return module_tree(text, m_options, statements, end);
       }
    }
-}
\ No newline at end of file
+}
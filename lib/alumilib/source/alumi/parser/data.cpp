@@ -1,6 +1,8 @@
 #include "alumi/parser/data.h"
 
 #include <utf8cpp/utf8.h>
+
+#include <iterator>
 namespace alumi
 {
    std::string as_utf8(UnicodeCodePoint cp)
@@ -17,4 +19,12 @@ namespace alumi
       }
       return output;
    }
+
+   std::u8string to_utf8(std::span<const UnicodeCodePoint> code_points)
+   {
+      std::u8string output;
+      output.reserve(code_points.size());
+      utf8::utf32to8(code_points.begin(), code_points.end(), std::back_inserter(output));
+      return output;
+   }
 }
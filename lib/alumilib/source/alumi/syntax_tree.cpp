@@ -4,9 +4,10 @@
 
 namespace alumi
 {
-   SyntaxTree::SyntaxTree(const parser::ParseResult& result, const LexedText* source)
-      : m_result(result)
-      , m_current_nodes(result.get_nodes())
+   SyntaxTree::SyntaxTree(const parser::ParseResult& result, const LexedText* source, std::shared_ptr<ParseContext> context)
+      : m_context(std::move(context))
+      , m_result(result)
+      , m_current_nodes(result.get_nodes().begin(), result.get_nodes().end())
       , m_source(source)
    {
 
@@ -32,6 +33,11 @@ namespace alumi
       return *m_source;
    }
 
+   const std::shared_ptr<ParseContext>& SyntaxTree::context() const
+   {
+      return m_context;
+   }
+
    std::vector<size_t> SyntaxTree::direct_tokens(const syntax_tree::Node* node) const
    {
       assert(node >= m_current_nodes.data() && node <= m_current_nodes.data() + m_current_nodes.size());
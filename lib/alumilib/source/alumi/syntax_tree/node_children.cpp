@@ -20,5 +20,14 @@ namespace alumi
 			return m_count;
 		}
 
+		void ChildGroup::grow(std::ptrdiff_t nodes)
+		{
+			m_count += nodes;
+		}
+		void ChildGroup::move(std::ptrdiff_t nodes)
+		{
+			m_skips += nodes;
+		}
+
 	}
 }
\ No newline at end of file
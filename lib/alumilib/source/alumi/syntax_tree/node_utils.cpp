@@ -1,5 +1,6 @@
 #include "alumi/syntax_tree/node_utils.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace alumi
@@ -22,12 +23,13 @@ namespace alumi
 			return index_offset;
 		}
 
-		std::vector<UnicodeCodePoint> as_string(const Node& node, const SyntaxTree& tree)
+		std::u8string as_string(const Node& node, const SyntaxTree& tree)
 		{
 			const auto& tokens = tree.source().tokens();
+			auto text = tree.source().text();
 
 			auto token_indices = tree.direct_tokens(&node);
-			std::vector<UnicodeCodePoint> result;
+			std::u8string result;
 			size_t prev_token_i = 0;
 
 			size_t text_start = 0;
@@ -35,16 +37,10 @@ namespace alumi
 
 			auto append_f = [&](size_t start, size_t end)
 			{
-				end = std::min(end, tree.source().text().size());
-				for (size_t i = start; i < end; ++i)
+				end = std::min(end, text.size());
+				if (start < end)
 				{
-					auto c = tree.source().text()[i];
-					if (c == '\n')
-					{
-						result.push_back('\\');
-						result.push_back('n');
-					}
-					result.push_back(c);
+					result += text.substr(start, end - start);
 				}
 			};
 
@@ -55,43 +51,33 @@ namespace alumi
 					append_f(text_start, text_end);
 					if (text_start < text_end)
 					{
-						result.push_back('.');
-						result.push_back('.');
-						result.push_back('.');
+						result += u8"...";
 					}
-					text_start = tokens[token_i].pos().char_index();
+					text_start = tokens[token_i].pos().byte_index();
 				}
 				else if ((token_i == token_indices[0]))
 				{
-					text_start = tokens[token_i].pos().char_index();
+					text_start = tokens[token_i].pos().byte_index();
 				}
-				text_end = tokens[token_i].pos().char_index() + tokens[token_i].size();
+				text_end = tokens[token_i].pos().byte_index() + tokens[token_i].size();
 				prev_token_i = token_i;
 			}
 			append_f(text_start, text_end);
 			return result;
 		}
 
-		std::vector<UnicodeCodePoint> as_string_deep(const Node& node, const SyntaxTree& tree)
+		std::u8string_view as_string_deep(const Node& node, const SyntaxTree& tree)
 		{
 			auto [start, end] = node.spans_tokens();
 			const auto& tokens = tree.source().tokens();
-
-			size_t text_start = tokens[start].pos().char_index();
-			size_t text_end = tokens[end - 1].pos().char_index() + tokens[end - 1].size() - 1;
-		
-			std::vector<UnicodeCodePoint> result;
-			for (size_t i = text_start; i < text_end; ++i)
+			if (start >= end)
 			{
-				auto c = tree.source().text()[i];
-				if (c == '\n')
-				{
-					result.push_back('\\');
-					result.push_back('n');
-				}
-				result.push_back(c);
+				return std::u8string_view();
 			}
-			return result;
+
+			size_t text_start = tokens[start].pos().byte_index();
+			size_t text_end = tokens[end - 1].pos().byte_index() + tokens[end - 1].size();
+			return tree.source().text().substr(text_start, text_end - text_start);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -55,6 +55,18 @@ namespace
       {
          return "Brancher";
       }
+      std::string operator()(DeferredBlock& node) const
+      {
+         return "DeferredBlock";
+      }
+      std::string operator()(UnaryOperation& node) const
+      {
+         return "UnaryOperation";
+      }
+      std::string operator()(BinaryOperation& node) const
+      {
+         return "BinaryOperation";
+      }
    };
 }
 
@@ -75,12 +87,12 @@ void TreeOpRepresentTree::operator()(SyntaxTreeWalker& walker, Node& node)
    name += node.visit(NodeOpStringify());
    representation += name + "(\"";
 
-   auto code_points = as_string(node, *m_tree);
-   for (auto c : code_points)
+   auto text = as_string(node, *m_tree);
+   for (char8_t c : text)
    {
       if (c != '\n')
       {
-         representation += as_utf8(c);
+         representation += static_cast<char>(c);
       }
       else
       {
@@ -2,10 +2,10 @@
 
 namespace alumi
 {
-   TextPos::TextPos(size_t line, size_t col, size_t char_index)
+   TextPos::TextPos(size_t line, size_t col, size_t byte_index)
       : m_line(line)
       , m_col(col)
-      , m_char_index(char_index)
+      , m_byte_index(byte_index)
    {
 
    }
@@ -20,8 +20,8 @@ namespace alumi
       return m_col;
    }
 
-   size_t TextPos::char_index() const
+   size_t TextPos::byte_index() const
    {
-      return m_char_index;
+      return m_byte_index;
    }
 }
\ No newline at end of file
@@ -62,6 +62,23 @@ TEST_CASE("Basics")
 			REQUIRE(tokens[5] == Token(TokenType::EndOfFile, TextPos(0, 3, 3), 0));
 
 		}
+		SECTION("Multibyte")
+		{
+			Lexer multibyte_lexer(
+				Tokenize(Repeats<Text, 1>(Text("\u00c5")), (TokenType)0),
+				Tokenize(Text("B"), (TokenType)1)
+			);
+			auto lexed_text = multibyte_lexer.lex(u8"\u00c5\u00c5B\n\u00c5");
+			Tokens tokens = lexed_text.tokens();
+
+			REQUIRE(tokens.size() == 8);
+			REQUIRE(tokens[1] == Token((TokenType)0, TextPos(0, 0, 0), 4));
+			REQUIRE(tokens[2] == Token((TokenType)1, TextPos(0, 4, 4), 1));
+			REQUIRE(tokens[3] == Token(TokenType::Linebreak, TextPos(0, 5, 5), 1));
+			REQUIRE(tokens[5] == Token((TokenType)0, TextPos(1, 0, 6), 2));
+			REQUIRE(lexed_text.token_text(1) == u8"\u00c5\u00c5");
+			REQUIRE(lexed_text.token_text(5) == u8"\u00c5");
+		}
 		SECTION("Basic with Trailing Linebreak")
 		{
 			Tokens tokens = lexer.lex(to_code_points("ABC\n")).tokens();
@@ -0,0 +1,131 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "alumi/lexer/alumi_lexicon.h"
+
+#include <functional>
+#include <string>
+
+using namespace alumi;
+
+namespace {
+	//!
+	//! Counts every step the lexer makes a pattern take, a deterministic stand in
+	//! for the time spent lexing
+	//!
+	template<LexerPattern T>
+	class Counted
+	{
+	public:
+		Counted(const T& pattern, size_t& steps)
+			: m_pattern(pattern)
+			, m_steps(&steps)
+		{
+
+		}
+
+		LexerResult check(UnicodeCodePoint cp, size_t index)
+		{
+			*m_steps += 1;
+			return m_pattern.check(cp, index);
+		}
+
+		LexerResult terminate(size_t index)
+		{
+			*m_steps += 1;
+			return m_pattern.terminate(index);
+		}
+
+	private:
+		T m_pattern;
+		size_t* m_steps;
+	};
+
+	//! The patterns of default_lexer, each of them counted
+	size_t steps_to_lex(const std::string& text)
+	{
+		size_t steps = 0;
+		auto lexer = Lexer(
+			Counted(AnyOf(ALUMI_WHITESPACE), steps),
+			Tokenize(Counted(Pattern(NotAnyOf(ALUMI_NUMERICS ALUMI_NON_SYMBOL_CHARS ALUMI_WHITESPACE), Repeats(NotAnyOf(ALUMI_NON_SYMBOL_CHARS ALUMI_WHITESPACE))), steps), TokenType::Symbol),
+			Tokenize(Counted(Repeats<AnyOf, 1>(AnyOf(ALUMI_OPERATOR_CHARS)), steps), TokenType::Operator),
+			Tokenize(Counted(Repeats<AnyOf, 1>(AnyOf(ALUMI_NUMERICS)), steps), TokenType::Literal),
+			Tokenize(Counted(Text(":="), steps), TokenType::Assignment),
+			Tokenize(Counted(Text("->"), steps), TokenType::ReturnOp),
+			Tokenize(Counted(Text("noop"), steps), TokenType::Noop),
+			Tokenize(Counted(Text(","), steps), TokenType::Seperator),
+			Tokenize(Counted(Text("("), steps), TokenType::SubscopeBegin),
+			Tokenize(Counted(Text(")"), steps), TokenType::SubScopeEnd),
+			Tokenize(Counted(Text(":"), steps), TokenType::ScopeBegin),
+			Tokenize(Counted(Text("fn"), steps), TokenType::FuncDeclare),
+			Tokenize(Counted(Text("if"), steps), TokenType::If),
+			Tokenize(Counted(Text("else"), steps), TokenType::Else),
+			Tokenize(Counted(Text("for"), steps), TokenType::For),
+			Tokenize(Counted(Text("while"), steps), TokenType::While)
+		);
+		lexer.lex(std::u8string(text.begin(), text.end()));
+		return steps;
+	}
+
+	std::string repeat(const std::string& text, size_t count)
+	{
+		std::string result;
+		result.reserve(text.size() * count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			result += text;
+		}
+		return result;
+	}
+
+	//!
+	//! Lexes inputs of growing size and checks that the work done by the patterns
+	//! grows linearly with it
+	//!
+	void require_linear_scaling(const std::function<std::string(size_t)>& text_for_size)
+	{
+		constexpr size_t base_size = 1000;
+
+		size_t previous_steps = steps_to_lex(text_for_size(base_size));
+		REQUIRE(previous_steps >= base_size);
+		for (size_t size = base_size * 2; size <= base_size * 16; size *= 2)
+		{
+			size_t steps = steps_to_lex(text_for_size(size));
+			// Doubling the input must at most roughly double the work, quadratic
+			// behaviour would quadruple it
+			REQUIRE(steps <= previous_steps * 5 / 2);
+			previous_steps = steps;
+		}
+	}
+}
+
+TEST_CASE("Linear Scaling")
+{
+	// The patterns of the lexicon fail within a few code points of where they stop matching, so maximal munch
+	// only ever steps back over those. These are the inputs where the patterns compete the longest
+
+	SECTION("Long Operator Run")
+	{
+		require_linear_scaling([](size_t size) { return repeat("+", size); });
+	}
+
+	SECTION("Operator Run Of Return Operators")
+	{
+		// Text("->") completes within the run that the operator pattern goes on to match as a whole
+		require_linear_scaling([](size_t size) { return repeat("->", size); });
+	}
+
+	SECTION("Operator Runs Between Assignments")
+	{
+		require_linear_scaling([](size_t size) { return repeat("a :=->-", size); });
+	}
+
+	SECTION("Long Symbol Starting Like Keywords")
+	{
+		require_linear_scaling([](size_t size) { return "whilefor" + repeat("e", size); });
+	}
+
+	SECTION("Long Literal")
+	{
+		require_linear_scaling([](size_t size) { return repeat("9", size); });
+	}
+}
@@ -4,6 +4,8 @@
 
 #include <utf8cpp/utf8.h>
 
+#include <limits>
+
 using namespace alumi;
 
 namespace {
@@ -60,4 +62,128 @@ TEST_CASE("Lex Snippets")
 				TokenType::EndOfFile,
 		}));
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lex Token Ending At Linebreak")
+{
+	auto lexed_text = default_lexer.lex(to_code_points("a:\n   noop"));
+
+	REQUIRE_THAT(get_types(lexed_text.tokens()), Catch::Matchers::Equals(std::vector<TokenType>{
+			TokenType::Indent,
+			TokenType::Symbol,
+			TokenType::ScopeBegin,
+			TokenType::Linebreak,
+			TokenType::Indent,
+			TokenType::Noop,
+			TokenType::Linebreak,
+			TokenType::EndOfFile,
+	}));
+}
+
+TEST_CASE("Lex Literal Values")
+{
+	SECTION("integers")
+	{
+		auto lexed_text = default_lexer.lex(to_code_points("foo := 42 + 7"));
+
+		REQUIRE(lexed_text.tokens()[3].type() == TokenType::Literal);
+		REQUIRE(lexed_text.tokens()[5].type() == TokenType::Literal);
+		REQUIRE(lexed_text.literals().size() == 2);
+		REQUIRE(lexed_text.literals().find(3) == LiteralValue::integer(42));
+		REQUIRE(lexed_text.literals().find(5) == LiteralValue::integer(7));
+		REQUIRE(lexed_text.literals().find(1) == std::nullopt);
+	}
+	SECTION("overflow")
+	{
+		auto lexed_text = default_lexer.lex(to_code_points("99999999999999999999\n9223372036854775807"));
+
+		REQUIRE(lexed_text.literals().overflow_count() == 1);
+
+		auto overflowed = lexed_text.literals().find(1);
+		REQUIRE(overflowed);
+		REQUIRE(overflowed->kind() == LiteralValue::Kind::Float);
+		REQUIRE(overflowed->overflowed());
+		REQUIRE(overflowed->as_float() == 1e20);
+
+		auto largest = lexed_text.literals().find(4);
+		REQUIRE(largest == LiteralValue::integer(9223372036854775807));
+	}
+}
+
+TEST_CASE("Lex Symbol Ids")
+{
+	auto lexed_text = default_lexer.lex(to_code_points("foo := bar\nbar := foo + baz"));
+	const auto& symbols = lexed_text.symbols();
+
+	REQUIRE(symbols.size() == 3);
+	REQUIRE(symbols.find(1) == SymbolId(0));
+	REQUIRE(symbols.find(3) == SymbolId(1));
+	REQUIRE(symbols.find(6) == SymbolId(1));
+	REQUIRE(symbols.find(8) == SymbolId(0));
+	REQUIRE(symbols.find(10) == SymbolId(2));
+	REQUIRE(symbols.find(2) == std::nullopt);
+	REQUIRE(symbols.spelling(2) == u8"baz");
+	REQUIRE(symbols.find_spelling(u8"bar") == SymbolId(1));
+	REQUIRE(symbols.find_spelling(u8"qux") == std::nullopt);
+
+	auto ids = lexed_text.columns().symbol_ids;
+	REQUIRE(ids.size() == lexed_text.tokens().size());
+	REQUIRE(ids[1] == SymbolId(0));
+	REQUIRE(ids[10] == SymbolId(2));
+	REQUIRE(ids[2] == SymbolTable::NO_SYMBOL);
+	REQUIRE(ids.back() == SymbolTable::NO_SYMBOL);
+
+	SECTION("copies keep their index")
+	{
+		SymbolTable copy = symbols;
+
+		REQUIRE(copy.find_spelling(u8"baz") == SymbolId(2));
+		REQUIRE(copy.spelling(0) == u8"foo");
+	}
+}
+
+TEST_CASE("Parse Literal")
+{
+	REQUIRE(parse_literal(u8"0") == LiteralValue::integer(0));
+	REQUIRE(parse_literal(u8"1234") == LiteralValue::integer(1234));
+	REQUIRE(parse_literal(u8"1.5") == LiteralValue::floating(1.5));
+	REQUIRE(parse_literal(u8"2e3") == LiteralValue::floating(2000.0));
+	REQUIRE(parse_literal(u8"1e999")->overflowed());
+	REQUIRE(parse_literal(u8"1e999")->as_float() == std::numeric_limits<double>::infinity());
+	REQUIRE(parse_literal(u8"1e-999")->overflowed());
+	REQUIRE(parse_literal(u8"1e-999")->as_float() == 0.0);
+	REQUIRE_FALSE(parse_literal(u8"1.5")->overflowed());
+	REQUIRE(parse_literal(u8"12a") == std::nullopt);
+	REQUIRE(parse_literal(u8"") == std::nullopt);
+}
+
+TEST_CASE("Lex UTF-8 Source")
+{
+	auto lexed_text = default_lexer.lex(u8"h\u00e4st := \u00f6l(1)");
+	const auto& tokens = lexed_text.tokens();
+
+	REQUIRE(tokens[1] == Token(TokenType::Symbol, TextPos(0, 0, 0), 5));
+	REQUIRE(tokens[2] == Token(TokenType::Assignment, TextPos(0, 6, 6), 2));
+	REQUIRE(tokens[3] == Token(TokenType::Symbol, TextPos(0, 9, 9), 3));
+	REQUIRE(lexed_text.token_text(1) == u8"h\u00e4st");
+	REQUIRE(lexed_text.token_text(3) == u8"\u00f6l");
+	REQUIRE(lexed_text.token_text(5) == u8"1");
+	REQUIRE(lexed_text.literals().find(5) == LiteralValue::integer(1));
+}
+
+TEST_CASE("Lex Token Columns")
+{
+	auto lexed_text = default_lexer.lex(to_code_points("foo := fn(type1 p1) -> type3\n   noop"));
+	auto columns = lexed_text.columns();
+
+	REQUIRE(columns.types.size() == lexed_text.tokens().size());
+	REQUIRE(columns.offsets.size() == lexed_text.tokens().size());
+	REQUIRE(columns.sizes.size() == lexed_text.tokens().size());
+	for (size_t i = 0; i < lexed_text.tokens().size(); ++i)
+	{
+		const Token& token = lexed_text.tokens()[i];
+		REQUIRE(columns.types[i] == token.type());
+		REQUIRE(columns.offsets[i] == token.pos().byte_index());
+		REQUIRE(columns.sizes[i] == token.size());
+	}
+}
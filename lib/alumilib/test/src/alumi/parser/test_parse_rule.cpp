@@ -50,7 +50,8 @@ namespace {
                Token(TokenType::Literal, TextPos(0, 2, 2), 2),
                Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0)
             };
-            Subparser parser(tokens);
+            ParseContext context;
+            Subparser parser(tokens, context);
 
             auto res = rule.parse(parser);
             REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -67,7 +68,8 @@ namespace {
                Token(TokenType::Indent, TextPos(0, 2, 2), 2),
                Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0)
             };
-            Subparser parser(tokens);
+            ParseContext context;
+            Subparser parser(tokens, context);
 
             auto res = rule.parse(parser);
             REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -105,7 +107,8 @@ namespace {
                Token(TokenType::Operator, TextPos(0, 2, 2), 2),
                Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0)
             };
-            Subparser parser(tokens);
+            ParseContext context;
+            Subparser parser(tokens, context);
 
             auto res = rule.parse(parser);
             REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -124,7 +127,8 @@ namespace {
                Token(TokenType::Symbol, TextPos(0, 4, 4), 2),
                Token(TokenType::EndOfFile, TextPos(0, 8, 8), 0)
             };
-            Subparser parser(tokens);
+            ParseContext context;
+            Subparser parser(tokens, context);
 
             auto res = rule.parse(parser);
             REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -144,7 +148,8 @@ namespace {
                Token(TokenType::Indent, TextPos(0, 2, 2), 2),
                Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0)
             };
-            Subparser parser(tokens);
+            ParseContext context;
+            Subparser parser(tokens, context);
 
             auto res = rule.parse(parser);
             REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -176,7 +181,8 @@ namespace {
             Token(TokenType::Indent, TextPos(0, 6, 6), 2),
             Token(TokenType::EndOfFile, TextPos(0, 8, 8), 0)
          };
-         Subparser parser(tokens);
+         ParseContext context;
+         Subparser parser(tokens, context);
 
          Rule1 rule;
          auto res = rule.parse(parser);
@@ -197,7 +203,8 @@ namespace {
             Token(TokenType::SubScopeEnd, TextPos(0, 6, 6), 2),
             Token(TokenType::EndOfFile, TextPos(0, 8, 8), 0)
          };
-         Subparser parser(tokens);
+         ParseContext context;
+         Subparser parser(tokens, context);
 
          Rule1 rule;
          auto res = rule.parse(parser);
@@ -211,6 +218,27 @@ namespace {
          REQUIRE(res.get_nodes().at(1).as<Error>().error_code == static_cast<ErrorCode>(3));
 
       }
+      SECTION("SynchronzieOnMatchedPair - Nested Pairs")
+      {
+         std::vector<Token> tokens{
+            Token(TokenType::SubscopeBegin, TextPos(0, 0, 0), 2),
+            Token(TokenType::SubscopeBegin, TextPos(0, 2, 2), 2),
+            Token(TokenType::SubscopeBegin, TextPos(0, 4, 4), 2),
+            Token(TokenType::SubScopeEnd, TextPos(0, 6, 6), 2),
+            Token(TokenType::SubScopeEnd, TextPos(0, 8, 8), 2),
+            Token(TokenType::SubScopeEnd, TextPos(0, 10, 10), 2),
+            Token(TokenType::EndOfFile, TextPos(0, 12, 12), 0)
+         };
+         ParseContext context;
+         Subparser parser(tokens, context);
+
+         Rule1 rule;
+         auto res = rule.parse(parser);
+
+         REQUIRE(res.get_type() == ParseResult::Type::RecoveredFailure);
+         REQUIRE(res.get_consumed() == 7);
+         REQUIRE(res.get_nodes().at(1).as<Error>().error_code == static_cast<ErrorCode>(3));
+      }
       SECTION("FailSynchronzieOnMatchedPair - Mismatched Pairs")
       {
          std::vector<Token> tokens{
@@ -219,7 +247,8 @@ namespace {
             Token(TokenType::SubScopeEnd, TextPos(0, 4, 4), 2),
             Token(TokenType::EndOfFile, TextPos(0, 8, 8), 0)
          };
-         Subparser parser(tokens);
+         ParseContext context;
+         Subparser parser(tokens, context);
 
          Rule1 rule;
          auto res = rule.parse(parser);
@@ -236,4 +265,249 @@ namespace {
 
    }
    
+   size_t shared_rule_builds = 0;
+   std::optional<Node> build_counted_node(const ParseResult& res)
+   {
+      shared_rule_builds += 1;
+      return build_node2(res);
+   }
+
+   TEST_CASE("Test Parse Rule - Memoization")
+   {
+      class Shared : public ParseRule<Repeats<Is<TokenType::Symbol>>, NeverSynchroize, build_counted_node> {};
+      class Rule1 : public ParseRule<AnyOf<Sequence<Shared, Is<TokenType::Operator>>, Sequence<Shared, Is<TokenType::Literal>>>, NeverSynchroize, build_node> {};
+
+      std::vector<Token> tokens{
+         Token(TokenType::Symbol, TextPos(0, 0, 0), 2),
+         Token(TokenType::Symbol, TextPos(0, 2, 2), 2),
+         Token(TokenType::Literal, TextPos(0, 4, 4), 2),
+         Token(TokenType::EndOfFile, TextPos(0, 6, 6), 0)
+      };
+
+      SECTION("Off")
+      {
+         shared_rule_builds = 0;
+         ParseContext context;
+         Subparser parser(tokens, context);
+
+         auto res = Rule1::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_consumed() == 3);
+         REQUIRE(shared_rule_builds == 2);
+         REQUIRE(parser.context().memoized_count() == 0);
+      }
+      SECTION("On")
+      {
+         shared_rule_builds = 0;
+         ParseContext context(ParseOptions{ .memoize = true });
+         Subparser parser(tokens, context);
+
+         auto res = Rule1::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_consumed() == 3);
+         REQUIRE(shared_rule_builds == 1);
+
+         REQUIRE(res.get_nodes().size() == 2);
+         REQUIRE(res.get_nodes().at(0).is<IntegerLiteral>());
+         REQUIRE(res.get_nodes().at(1).is<Expression>());
+      }
+      SECTION("Different Swallowing Is Not Reused")
+      {
+         shared_rule_builds = 0;
+         ParseContext context(ParseOptions{ .memoize = true });
+         Subparser parser(tokens, context);
+         Subparser swallowing = parser;
+         swallowing.add_swallowed_token(TokenType::Literal);
+
+         REQUIRE(Shared::parse(parser).get_consumed() == 2);
+         REQUIRE(Shared::parse(swallowing).get_consumed() == 2);
+         REQUIRE(shared_rule_builds == 2);
+      }
+   }
+
+   TEST_CASE("Test Parse Rule - First Sets")
+   {
+      SECTION("Sets")
+      {
+         constexpr FirstSet sequence = Sequence<Optional<Is<TokenType::Symbol>>, Is<TokenType::Literal>, Is<TokenType::Noop>>::first_set();
+         REQUIRE(sequence.tokens.contains(TokenType::Symbol));
+         REQUIRE(sequence.tokens.contains(TokenType::Literal));
+         REQUIRE(!sequence.tokens.contains(TokenType::Noop));
+         REQUIRE(!sequence.nullable);
+
+         constexpr FirstSet repeats = Repeats<Is<TokenType::Symbol>>::first_set();
+         REQUIRE(repeats.nullable);
+      }
+
+      class Counted : public ParseRule<Is<TokenType::Symbol>, NeverSynchroize, build_counted_node> {};
+      class Recovering : public ParseRule<Sequence<Is<TokenType::Symbol>, Is<TokenType::Indent>>, SynchronizeOnToken<TokenType::Indent>, build_node2> {};
+
+      SECTION("Recovering Sets")
+      {
+         REQUIRE(!Counted::first_set().recovers);
+         REQUIRE(Counted::first_set().rules_out(TokenType::Noop));
+         REQUIRE(Recovering::first_set().recovers);
+         REQUIRE(!Recovering::first_set().rules_out(TokenType::Noop));
+         REQUIRE(Sequence<Recovering, Is<TokenType::Noop>>::first_set().recovers);
+         REQUIRE(!Peek<Recovering>::first_set().recovers);
+      }
+      SECTION("Does Not Try Repeats That Cannot Start")
+      {
+         std::vector<Token> tokens{
+            Token(TokenType::Symbol, TextPos(0, 0, 0), 3),
+            Token(TokenType::Noop, TextPos(0, 3, 3), 4),
+            Token(TokenType::EndOfFile, TextPos(0, 7, 7), 0)
+         };
+         shared_rule_builds = 0;
+         ParseContext context;
+         Subparser parser(tokens, context);
+
+         auto res = Sequence<Repeats<Counted>, Optional<Counted>, Is<TokenType::Noop>>::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_consumed() == 2);
+         REQUIRE(res.get_nodes().size() == 1);
+         // Only the symbol is parsed, the rule is not built to fail on the noop
+         REQUIRE(shared_rule_builds == 1);
+      }
+
+      SECTION("Skips Alternatives That Cannot Start")
+      {
+         std::vector<Token> tokens{
+            Token(TokenType::Noop, TextPos(0, 0, 0), 4),
+            Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0)
+         };
+         shared_rule_builds = 0;
+         ParseContext context;
+         Subparser parser(tokens, context);
+
+         auto res = AnyOf<Counted, Is<TokenType::Noop>>::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_consumed() == 1);
+         REQUIRE(shared_rule_builds == 0);
+      }
+      SECTION("Still Fails On The Best Alternative")
+      {
+         std::vector<Token> tokens{
+            Token(TokenType::Operator, TextPos(0, 0, 0), 2),
+            Token(TokenType::Indent, TextPos(0, 2, 2), 2),
+            Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0)
+         };
+         ParseContext context;
+         Subparser parser(tokens, context);
+
+         auto res = AnyOf<Is<TokenType::Noop>, Recovering>::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::RecoveredFailure);
+         REQUIRE(res.get_consumed() == 2);
+         REQUIRE(res.get_nodes().size() == 1);
+         REQUIRE(res.get_nodes().at(0).as<Error>().error_code == static_cast<ErrorCode>(2));
+      }
+   }
+
+   std::optional<Node> build_no_node(const ParseResult&)
+   {
+      return std::nullopt;
+   }
+
+   TEST_CASE("Test Parse Rule - Rules Without Nodes")
+   {
+      class Leaf : public ParseRule<Is<TokenType::Symbol>, NeverSynchroize, build_node> {};
+      class Group : public ParseRule<Sequence<Leaf, Leaf>, NeverSynchroize, build_no_node> {};
+      class Outer : public ParseRule<Sequence<Group, Group, Leaf>, NeverSynchroize, build_node2> {};
+
+      std::vector<Token> tokens{
+         Token(TokenType::Symbol, TextPos(0, 0, 0), 1),
+         Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
+         Token(TokenType::Symbol, TextPos(0, 2, 2), 1),
+         Token(TokenType::Symbol, TextPos(0, 3, 3), 1),
+         Token(TokenType::Symbol, TextPos(0, 4, 4), 1),
+         Token(TokenType::EndOfFile, TextPos(0, 5, 5), 0)
+      };
+
+      SECTION("Children Take Its Place")
+      {
+         ParseContext context;
+         Subparser parser(tokens, context);
+
+         auto res = Group::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_nodes().size() == 2);
+         REQUIRE(res.get_nodes().at(0).is<IntegerLiteral>());
+         REQUIRE(res.get_nodes().at(1).is<IntegerLiteral>());
+      }
+      SECTION("Removed Slots Are Dropped Before The Parent Is Built")
+      {
+         ParseContext context;
+         Subparser parser(tokens, context);
+
+         auto res = Outer::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_consumed() == 5);
+         REQUIRE(res.get_nodes().size() == 6);
+         REQUIRE(res.get_nodes().at(0).is<Expression>());
+         for (size_t index = 1; index < 6; ++index)
+         {
+            REQUIRE(res.get_nodes().at(index).is<IntegerLiteral>());
+         }
+         REQUIRE(parser.context().nodes().mark() == 6);
+      }
+      SECTION("Memoized")
+      {
+         ParseContext context(ParseOptions{ .memoize = true });
+         Subparser parser(tokens, context);
+
+         auto res = Outer::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_nodes().size() == 6);
+         REQUIRE(res.get_nodes().at(0).is<Expression>());
+         REQUIRE(res.get_nodes().at(5).is<IntegerLiteral>());
+      }
+   }
+
+   TEST_CASE("Test Parse Rule - Error Limit")
+   {
+      class Recovering : public ParseRule<Sequence<Is<TokenType::Symbol>, Is<TokenType::Indent>>, SynchronizeOnToken<TokenType::Indent>, build_node2> {};
+      class Outer : public ParseRule<Sequence<Optional<Sequence<Recovering, Is<TokenType::Literal>>>, Is<TokenType::Symbol>, Repeats<Is<TokenType::Operator>>>, NeverSynchroize, build_node> {};
+
+      SECTION("Errors Rolled Back Do Not Count")
+      {
+         std::vector<Token> tokens{
+            Token(TokenType::Symbol, TextPos(0, 0, 0), 1),
+            Token(TokenType::Operator, TextPos(0, 1, 1), 1),
+            Token(TokenType::Indent, TextPos(0, 2, 2), 1),
+            Token(TokenType::Symbol, TextPos(0, 3, 3), 1),
+            Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0)
+         };
+         ParseContext context(ParseOptions{ .max_errors = 1 });
+         Subparser parser(tokens, context);
+
+         // Recovering recovers with an error, but the Optional drops it as no literal follows
+         auto res = Outer::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Success);
+         REQUIRE(res.get_consumed() == 2);
+         REQUIRE_FALSE(parser.context().is_stopped());
+      }
+      SECTION("Errors Kept Count")
+      {
+         std::vector<Token> tokens{
+            Token(TokenType::Symbol, TextPos(0, 0, 0), 1),
+            Token(TokenType::Operator, TextPos(0, 1, 1), 1),
+            Token(TokenType::Indent, TextPos(0, 2, 2), 1),
+            Token(TokenType::Literal, TextPos(0, 3, 3), 1),
+            Token(TokenType::Symbol, TextPos(0, 4, 4), 1),
+            Token(TokenType::Operator, TextPos(0, 5, 5), 1),
+            Token(TokenType::EndOfFile, TextPos(0, 6, 6), 0)
+         };
+         ParseContext context(ParseOptions{ .max_errors = 1 });
+         Subparser parser(tokens, context);
+
+         // Stops before the repeats, and Outer leaves its nodes as they are instead of building its own
+         auto res = Outer::parse(parser);
+         REQUIRE(res.get_type() == ParseResult::Type::Failure);
+         REQUIRE(parser.context().stop_reason() == ErrorCode::TooManyErrors);
+         REQUIRE(res.get_nodes().size() == 2);
+         REQUIRE(res.get_nodes().at(0).as<Error>().error_code == static_cast<ErrorCode>(2));
+         REQUIRE(res.get_nodes().at(1).as<Error>().error_code == ErrorCode::TooManyErrors);
+      }
+   }
+
 }
\ No newline at end of file
@@ -5,10 +5,17 @@
 
 #include "alumi/syntax_tree/tree_utiltiy_ops.h"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <stop_token>
+#include <string>
+#include <typeindex>
 
 #include <utf8cpp/utf8.h>
 
+import alumi.parser.error_codes;
+
 using namespace alumi;
 using namespace alumi::parser;
 using namespace alumi::syntax_tree;
@@ -44,6 +51,40 @@ namespace {
 		f.open(filename, std::ios::out);
 		f << representer.representation;
 	}
+
+	std::type_index node_type(const Node& node)
+	{
+		return node.visit([](const auto& actual) { return std::type_index(typeid(actual)); });
+	}
+
+	bool has_errors(const SyntaxTree& tree)
+	{
+		return std::any_of(tree.nodes().begin(), tree.nodes().end(), [](const Node& node) { return node.is<Error>(); });
+	}
+
+	//!
+	//! Requires a tree to be the same as the one the serial parse gave, node for node
+	//!
+	void require_same_tree(const SyntaxTree& tree, const SyntaxTree& serial)
+	{
+		REQUIRE(tree.parse_result().get_type() == serial.parse_result().get_type());
+		REQUIRE(tree.parse_result().get_consumed() == serial.parse_result().get_consumed());
+
+		REQUIRE(tree.nodes().size() == serial.nodes().size());
+		for (size_t i = 0; i < tree.nodes().size(); ++i)
+		{
+			const Node& node = tree.nodes()[i];
+			const Node& serial_node = serial.nodes()[i];
+			REQUIRE(node_type(node) == node_type(serial_node));
+			REQUIRE(node.spans_tokens() == serial_node.spans_tokens());
+			REQUIRE(node.child_group_count() == serial_node.child_group_count());
+			for (size_t group = 0; group < node.child_group_count(); ++group)
+			{
+				REQUIRE(node.child_group(group).get_skips() == serial_node.child_group(group).get_skips());
+				REQUIRE(node.child_group(group).get_count() == serial_node.child_group(group).get_count());
+			}
+		}
+	}
 }
 
 TEST_CASE("Test Main Func")
@@ -85,6 +126,29 @@ TEST_CASE("Test Main Func")
 		REQUIRE(tree.parse_result().get_consumed() == 16);
 
 	}
+	SECTION("Deferred Body")
+	{
+		auto code_points = to_code_points(""
+			"main := fn(env Environment) -> ResultCode:\n"
+			"   noop"
+			"");
+
+		auto lexed_text = default_lexer.lex(code_points);
+
+		AlumiParser parser(ParseOptions{ .defer_blocks = true });
+		auto tree = parser.parse(lexed_text);
+
+		REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+		REQUIRE(tree.parse_result().get_consumed() == 16);
+
+		auto deferred = std::find_if(tree.nodes().begin(), tree.nodes().end(), [](const Node& node) { return node.is<DeferredBlock>(); });
+		REQUIRE(deferred != tree.nodes().end());
+
+		auto body = parser.parse_deferred(lexed_text, *deferred);
+		REQUIRE(body.parse_result().get_type() == ParseResult::Type::Success);
+		REQUIRE(body.nodes().front().is<CodeBlock>());
+		REQUIRE(body.nodes().front().spans_tokens() == deferred->spans_tokens());
+	}
 }
 TEST_CASE("Test integer Func")
 {
@@ -155,3 +219,473 @@ TEST_CASE("Test primitive decleration")
 		REQUIRE(tree.parse_result().get_consumed() == 7);
 	}
 }
+
+TEST_CASE("Test operator precedence")
+{
+	auto parse = [](const std::string_view& source)
+	{
+		AlumiParser parser;
+		return parser.parse(default_lexer.lex(to_code_points(source)));
+	};
+	auto first_operation = [](const SyntaxTree& tree)
+	{
+		return std::find_if(tree.nodes().begin(), tree.nodes().end(), [](const Node& node) { return node.is<BinaryOperation>() || node.is<UnaryOperation>(); });
+	};
+
+	SECTION("Infix Operators Of Higher Precedence Bind Tighter")
+	{
+		auto tree = parse("foo := 1 + 2 * 3");
+		REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+
+		auto sum = first_operation(tree);
+		REQUIRE(sum != tree.nodes().end());
+		REQUIRE(sum->as<BinaryOperation>().op == u8"+");
+		REQUIRE(sum->recursive_child_count() == 5);
+
+		// The multiplication binds tighter, so it is the right hand operand of the addition
+		auto product = sum + 2;
+		REQUIRE(product->is<BinaryOperation>());
+		REQUIRE(product->as<BinaryOperation>().op == u8"*");
+		REQUIRE(product->spans_tokens() == std::tuple<size_t, size_t>{ 5, 8 });
+	}
+
+	SECTION("Infix Operators Of The Same Precedence Group From The Left")
+	{
+		auto tree = parse("foo := 1 - 2 - 3");
+		REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+
+		auto outer = first_operation(tree);
+		REQUIRE(outer != tree.nodes().end());
+		REQUIRE(outer->as<BinaryOperation>().op == u8"-");
+		REQUIRE(outer->spans_tokens() == std::tuple<size_t, size_t>{ 3, 8 });
+		REQUIRE(outer->recursive_child_count() == 5);
+
+		// 1 - 2 is the left hand operand of the second subtraction
+		auto inner = outer + 1;
+		REQUIRE(inner->is<BinaryOperation>());
+		REQUIRE(inner->as<BinaryOperation>().op == u8"-");
+		REQUIRE(inner->spans_tokens() == std::tuple<size_t, size_t>{ 3, 6 });
+	}
+
+	SECTION("Prefix Operators Bind Tighter Than Infix Operators")
+	{
+		auto tree = parse("foo := -1 * 2");
+		REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+
+		auto product = first_operation(tree);
+		REQUIRE(product != tree.nodes().end());
+		REQUIRE(product->is<BinaryOperation>());
+		REQUIRE(product->as<BinaryOperation>().op == u8"*");
+		REQUIRE(product->spans_tokens() == std::tuple<size_t, size_t>{ 3, 7 });
+
+		auto negation = product + 1;
+		REQUIRE(negation->is<UnaryOperation>());
+		REQUIRE(negation->as<UnaryOperation>().op == u8"-");
+		REQUIRE(negation->spans_tokens() == std::tuple<size_t, size_t>{ 3, 5 });
+	}
+
+	SECTION("An Operator Can Be Both Prefix And Infix")
+	{
+		auto tree = parse("foo := 1 - -2");
+		REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+
+		auto difference = first_operation(tree);
+		REQUIRE(difference != tree.nodes().end());
+		REQUIRE(difference->is<BinaryOperation>());
+		REQUIRE(difference->as<BinaryOperation>().op == u8"-");
+		REQUIRE(difference->spans_tokens() == std::tuple<size_t, size_t>{ 3, 7 });
+		REQUIRE(difference->recursive_child_count() == 4);
+
+		auto negation = difference + 2;
+		REQUIRE(negation->is<UnaryOperation>());
+		REQUIRE(negation->as<UnaryOperation>().op == u8"-");
+		REQUIRE(negation->spans_tokens() == std::tuple<size_t, size_t>{ 5, 7 });
+	}
+
+	SECTION("An Operator The Table Does Not Know Ends The Expression")
+	{
+		auto tree = parse("foo := 1 + 2 <<< 3");
+
+		// The expression stops before the unknown operator, which the statement then cannot take
+		auto sum = first_operation(tree);
+		REQUIRE(sum != tree.nodes().end());
+		REQUIRE(sum->as<BinaryOperation>().op == u8"+");
+		REQUIRE(sum->spans_tokens() == std::tuple<size_t, size_t>{ 3, 6 });
+		REQUIRE(has_errors(tree));
+	}
+
+	SECTION("A Trailing Infix Operator Fails")
+	{
+		auto tree = parse("foo := 1 +");
+
+		REQUIRE(first_operation(tree) == tree.nodes().end());
+		REQUIRE(has_errors(tree));
+	}
+}
+
+TEST_CASE("Test parallel top level parse")
+{
+	auto code_points = to_code_points(""
+		"foo := 5\n"
+		"\n"
+		"bar := 6\n"
+		"\n"
+		"baz := 7\n"
+		"");
+
+	auto lexed_text = default_lexer.lex(code_points);
+
+	AlumiParser sequential_parser;
+	auto sequential_tree = sequential_parser.parse(lexed_text);
+
+	AlumiParser parallel_parser(ParseOptions{ .threads = 2 });
+	auto parallel_tree = parallel_parser.parse(lexed_text);
+
+	REQUIRE(sequential_tree.parse_result().get_type() == ParseResult::Type::Success);
+	require_same_tree(parallel_tree, sequential_tree);
+}
+
+TEST_CASE("Test pipelined parse")
+{
+	std::u8string_view source = u8""
+		"foo := 5\n"
+		"\n"
+		"bar := 6\n"
+		"\n"
+		"baz := 7\n"
+		"";
+
+	auto lexed_text = default_lexer.lex(source);
+
+	AlumiParser parser;
+	auto tree = parser.parse(lexed_text);
+	auto pipelined = parser.parse_pipelined(default_lexer, source);
+
+	REQUIRE(pipelined.text->tokens() == lexed_text.tokens());
+	REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+	require_same_tree(pipelined.tree, tree);
+}
+
+TEST_CASE("Test pipelined parse through a small ring")
+{
+	// Several runs of statements, through a ring that fills up and wraps around many times while lexing
+	std::u8string source;
+	for (int statement = 0; statement < 200; ++statement)
+	{
+		std::string line = (statement == 0 ? "" : "\n") + std::string("v") + std::to_string(statement) + " := " + std::to_string(statement) + "\n";
+		source.append(line.begin(), line.end());
+	}
+
+	auto lexed_text = default_lexer.lex(source);
+
+	AlumiParser parser;
+	auto tree = parser.parse(lexed_text);
+	auto pipelined = parser.parse_pipelined(default_lexer, source, 16);
+
+	REQUIRE(pipelined.text->tokens() == lexed_text.tokens());
+	REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+	require_same_tree(pipelined.tree, tree);
+}
+
+TEST_CASE("Test iterative parse")
+{
+	auto code_points = to_code_points(""
+		"main := fn(env Environment) -> ResultCode:\n"
+		"   inner := fn(inp int32) -> int32:\n"
+		"      innermost := fn(inp int32) -> int32:\n"
+		"         noop\n"
+		"");
+
+	auto lexed_text = default_lexer.lex(code_points);
+
+	AlumiParser recursive_parser;
+	auto recursive_tree = recursive_parser.parse(lexed_text);
+
+	AlumiParser iterative_parser(ParseOptions{ .iterative = true });
+	auto iterative_tree = iterative_parser.parse(lexed_text);
+
+	REQUIRE(recursive_tree.parse_result().get_type() == ParseResult::Type::Success);
+	require_same_tree(iterative_tree, recursive_tree);
+}
+
+TEST_CASE("Test iterative parse of a broken body")
+{
+	auto code_points = to_code_points(""
+		"main := fn(env Environment) -> ResultCode:\n"
+		"   inner := fn(inp int32) -> int32:\n"
+		"      innermost := 5 <<<\n"
+		"");
+
+	auto lexed_text = default_lexer.lex(code_points);
+
+	auto is_deferred = [](const Node& node) { return node.is<DeferredBlock>(); };
+	auto is_error = [](const Node& node) { return node.is<Error>() && node.as<Error>().error_code == ErrorCode::Unknown; };
+	auto is_limit = [](const Node& node) { return node.is<Error>() && node.as<Error>().error_code == ErrorCode::TooManyErrors; };
+
+	SECTION("Recovered Body")
+	{
+		AlumiParser recursive_parser;
+		auto recursive_tree = recursive_parser.parse(lexed_text);
+
+		AlumiParser iterative_parser(ParseOptions{ .iterative = true });
+		auto iterative_tree = iterative_parser.parse(lexed_text);
+
+		REQUIRE(recursive_tree.parse_result().get_type() == ParseResult::Type::RecoveredFailure);
+		require_same_tree(iterative_tree, recursive_tree);
+	}
+
+	SECTION("Body That Fails Outright")
+	{
+		// The body of inner fails on its first error, which stops the parse
+		AlumiParser recursive_parser(ParseOptions{ .max_errors = 1 });
+		auto recursive_tree = recursive_parser.parse(lexed_text);
+
+		AlumiParser iterative_parser(ParseOptions{ .iterative = true, .max_errors = 1 });
+		auto iterative_tree = iterative_parser.parse(lexed_text);
+
+		REQUIRE(recursive_tree.parse_result().get_type() == ParseResult::Type::Failure);
+		REQUIRE(iterative_tree.parse_result().get_type() == ParseResult::Type::Failure);
+		REQUIRE(iterative_tree.nodes().front().recursive_child_count() == iterative_tree.nodes().size());
+		REQUIRE(std::none_of(iterative_tree.nodes().begin(), iterative_tree.nodes().end(), is_deferred));
+
+		// The failed body is spliced in, so the error it failed on and where the parse stopped are reported as in the recursive parse
+		auto recursive_error = std::find_if(recursive_tree.nodes().rbegin(), recursive_tree.nodes().rend(), is_error);
+		auto iterative_error = std::find_if(iterative_tree.nodes().rbegin(), iterative_tree.nodes().rend(), is_error);
+		REQUIRE(recursive_error != recursive_tree.nodes().rend());
+		REQUIRE(iterative_error != iterative_tree.nodes().rend());
+		REQUIRE(iterative_error->spans_tokens() == recursive_error->spans_tokens());
+		REQUIRE(iterative_error->as<Error>().token_index == recursive_error->as<Error>().token_index);
+
+		auto recursive_limit = std::find_if(recursive_tree.nodes().begin(), recursive_tree.nodes().end(), is_limit);
+		auto iterative_limit = std::find_if(iterative_tree.nodes().begin(), iterative_tree.nodes().end(), is_limit);
+		REQUIRE(recursive_limit != recursive_tree.nodes().end());
+		REQUIRE(iterative_limit != iterative_tree.nodes().end());
+		REQUIRE(std::count_if(iterative_tree.nodes().begin(), iterative_tree.nodes().end(), is_limit) == 1);
+		REQUIRE(iterative_limit->as<Error>().token_index == recursive_limit->as<Error>().token_index);
+	}
+}
+
+TEST_CASE("Test incremental reparse")
+{
+	// Tokens 0 to 4 are "foo := 5", 5 the blank line, 6 to 10 "bar := 6", 11 the blank line and 12 to 16 "baz := 7"
+	auto old_code_points = to_code_points(""
+		"foo := 5\n"
+		"\n"
+		"bar := 6\n"
+		"\n"
+		"baz := 7\n"
+		"");
+	auto old_lexed_text = default_lexer.lex(old_code_points);
+
+	AlumiParser parser;
+	auto old_tree = parser.parse(old_lexed_text);
+	REQUIRE(old_tree.parse_result().get_type() == ParseResult::Type::Success);
+
+	SECTION("Insertion")
+	{
+		auto new_lexed_text = default_lexer.lex(to_code_points(""
+			"foo := 5\n"
+			"\n"
+			"qux := 8\n"
+			"\n"
+			"bar := 6\n"
+			"\n"
+			"baz := 7\n"
+			""));
+		auto full_tree = parser.parse(new_lexed_text);
+
+		// The line "qux := 8" and the blank line after it were inserted before the indent starting "bar := 6"
+		auto tree = parser.reparse(old_tree, new_lexed_text, TokenEdit{ 6, 6, 12 });
+
+		REQUIRE(full_tree.parse_result().get_type() == ParseResult::Type::Success);
+		require_same_tree(tree, full_tree);
+	}
+
+	SECTION("Edit Inside A Statement")
+	{
+		auto new_lexed_text = default_lexer.lex(to_code_points(""
+			"foo := 5\n"
+			"\n"
+			"bar := 60 + 1\n"
+			"\n"
+			"baz := 7\n"
+			""));
+		auto full_tree = parser.parse(new_lexed_text);
+
+		// The literal 6 became 60 + 1
+		auto tree = parser.reparse(old_tree, new_lexed_text, TokenEdit{ 9, 10, 12 });
+
+		REQUIRE(full_tree.parse_result().get_type() == ParseResult::Type::Success);
+		require_same_tree(tree, full_tree);
+	}
+
+	SECTION("Deletion")
+	{
+		auto new_lexed_text = default_lexer.lex(to_code_points(""
+			"foo := 5\n"
+			"\n"
+			"baz := 7\n"
+			""));
+		auto full_tree = parser.parse(new_lexed_text);
+
+		// The line "bar := 6" and the blank line after it were removed, so the statements after move back
+		auto tree = parser.reparse(old_tree, new_lexed_text, TokenEdit{ 6, 12, 6 });
+
+		REQUIRE(full_tree.parse_result().get_type() == ParseResult::Type::Success);
+		require_same_tree(tree, full_tree);
+	}
+
+	SECTION("Reparsed Statements That Fail Fall Back To A Full Parse")
+	{
+		auto new_lexed_text = default_lexer.lex(to_code_points(""
+			"foo := 5\n"
+			"\n"
+			"bar := 6 6\n"
+			"\n"
+			"baz := 7\n"
+			""));
+		auto full_tree = parser.parse(new_lexed_text);
+
+		// The literal 6 became 6 6, which does not parse
+		auto tree = parser.reparse(old_tree, new_lexed_text, TokenEdit{ 9, 10, 11 });
+
+		REQUIRE(has_errors(full_tree));
+		require_same_tree(tree, full_tree);
+	}
+
+	SECTION("Reparsed Statements That Do Not Line Up Fall Back To A Full Parse")
+	{
+		auto new_lexed_text = default_lexer.lex(to_code_points(""
+			"foo := 5\n"
+			"\n"
+			"bar := 6\n"
+			"   qux := 8\n"
+			"\n"
+			"baz := 7\n"
+			""));
+		auto full_tree = parser.parse(new_lexed_text);
+
+		// The indented line "qux := 8" was inserted after "bar := 6", which ends before it rather than where "baz := 7" starts
+		auto tree = parser.reparse(old_tree, new_lexed_text, TokenEdit{ 11, 11, 16 });
+
+		REQUIRE(has_errors(full_tree));
+		require_same_tree(tree, full_tree);
+	}
+
+	SECTION("Old Tree With Errors Falls Back To A Full Parse")
+	{
+		auto broken_lexed_text = default_lexer.lex(to_code_points(""
+			"foo := 5\n"
+			"\n"
+			"bar := 6 6\n"
+			"\n"
+			"baz := 7\n"
+			""));
+		auto broken_tree = parser.parse(broken_lexed_text);
+		REQUIRE(has_errors(broken_tree));
+
+		// The second 6 is removed again, which gives the old text back
+		auto tree = parser.reparse(broken_tree, old_lexed_text, TokenEdit{ 10, 11, 10 });
+
+		require_same_tree(tree, old_tree);
+	}
+}
+
+TEST_CASE("Test parse tracing")
+{
+	auto code_points = to_code_points(""
+		"main := fn(env Environment) -> ResultCode:\n"
+		"   noop"
+		"");
+
+	auto lexed_text = default_lexer.lex(code_points);
+
+	AlumiParser parser;
+	auto tree = parser.parse(lexed_text);
+
+	auto statistics = tree.parse_result().get_subparser().context().tracer().statistics();
+#ifdef ALUMI_PARSER_TRACING
+	// Sorted by time, so the root rule is not necessarily first
+	auto root = std::find_if(statistics.begin(), statistics.end(), [](const RuleStatistics& rule) { return rule.rule == "AlumiGrammar"; });
+	REQUIRE(root != statistics.end());
+	REQUIRE(root->invocations == 1);
+	REQUIRE(root->tokens_consumed == 16);
+#else
+	REQUIRE(statistics.empty());
+#endif
+}
+
+TEST_CASE("Test cancelled parse")
+{
+	auto code_points = to_code_points(""
+		"foo := 5\n"
+		"\n"
+		"bar := 6\n"
+		"");
+
+	auto lexed_text = default_lexer.lex(code_points);
+
+	auto is_cancelled = [](const Node& node) { return node.is<Error>() && node.as<Error>().error_code == ErrorCode::Cancelled; };
+
+	std::stop_source stop;
+	stop.request_stop();
+	AlumiParser stopped_parser(ParseOptions{ .stop_token = stop.get_token() });
+	auto stopped_tree = stopped_parser.parse(lexed_text);
+
+	// Stops before the statement after "foo := 5", which was parsed already
+	REQUIRE(stopped_tree.parse_result().get_type() == ParseResult::Type::Failure);
+	REQUIRE(std::count_if(stopped_tree.nodes().begin(), stopped_tree.nodes().end(), is_cancelled) == 1);
+	REQUIRE(stopped_tree.nodes().back().spans_tokens() == std::tuple<size_t, size_t>(6, 6));
+
+	AlumiParser late_parser(ParseOptions{ .deadline = std::chrono::steady_clock::now() - std::chrono::seconds(1) });
+	auto late_tree = late_parser.parse(lexed_text);
+
+	REQUIRE(late_tree.parse_result().get_type() == ParseResult::Type::Failure);
+	REQUIRE(std::count_if(late_tree.nodes().begin(), late_tree.nodes().end(), is_cancelled) == 1);
+
+	AlumiParser parser(ParseOptions{ .deadline = std::chrono::steady_clock::now() + std::chrono::hours(1) });
+	auto tree = parser.parse(lexed_text);
+
+	REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+	REQUIRE(std::none_of(tree.nodes().begin(), tree.nodes().end(), is_cancelled));
+}
+
+TEST_CASE("Test error limit")
+{
+	auto code_points = to_code_points(""
+		"foo := 5\n"
+		"\n"
+		"bar := 6 <<<\n"
+		"\n"
+		"baz := 7 <<<\n"
+		"\n"
+		"qux := 8\n"
+		"");
+
+	auto lexed_text = default_lexer.lex(code_points);
+
+	auto is_error = [](const Node& node) { return node.is<Error>(); };
+	auto is_limit = [](const Node& node) { return node.is<Error>() && node.as<Error>().error_code == ErrorCode::TooManyErrors; };
+
+	AlumiParser parser;
+	auto tree = parser.parse(lexed_text);
+
+	REQUIRE(tree.parse_result().get_type() != ParseResult::Type::Failure);
+	REQUIRE(std::count_if(tree.nodes().begin(), tree.nodes().end(), is_error) == 2);
+	REQUIRE(std::none_of(tree.nodes().begin(), tree.nodes().end(), is_limit));
+
+	// Fails on the first error instead of recovering from it, leaving "baz := 7 <<<" unparsed
+	AlumiParser fail_fast_parser(ParseOptions{ .max_errors = 1 });
+	auto fail_fast_tree = fail_fast_parser.parse(lexed_text);
+
+	REQUIRE(fail_fast_tree.parse_result().get_type() == ParseResult::Type::Failure);
+	REQUIRE(std::count_if(fail_fast_tree.nodes().begin(), fail_fast_tree.nodes().end(), is_limit) == 1);
+	REQUIRE(fail_fast_tree.nodes().front().recursive_child_count() == fail_fast_tree.nodes().size());
+	REQUIRE(fail_fast_tree.nodes().size() < tree.nodes().size());
+
+	AlumiParser lenient_parser(ParseOptions{ .max_errors = 3 });
+	auto lenient_tree = lenient_parser.parse(lexed_text);
+
+	REQUIRE(lenient_tree.parse_result().get_type() == tree.parse_result().get_type());
+	REQUIRE(lenient_tree.nodes().size() == tree.nodes().size());
+}
@@ -1,5 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <optional>
+
 import alumi.parser;
 
 using namespace alumi;
@@ -17,7 +19,8 @@ TEST_CASE("Test Parser Parts")
 			std::vector<Token> tokens{
 				Token(TokenType::Symbol, TextPos(0, 0, 0), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -30,7 +33,8 @@ TEST_CASE("Test Parser Parts")
 			std::vector<Token> tokens{
 				Token(TokenType::Literal, TextPos(0, 0, 0), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 			
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -50,7 +54,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Indent, TextPos(0, 2, 2), 2),
 				Token(TokenType::Symbol, TextPos(0, 4, 4), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -64,13 +69,38 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Indent, TextPos(0, 2, 2), 2),
 				Token(TokenType::Literal, TextPos(0, 0, 0), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
 			REQUIRE(res.get_consumed() == 2);
 			//REQUIRE(res.get_nodes().size() == 0);
 		}
+
+		SECTION("Nested Swallowing")
+		{
+			std::vector<Token> tokens{
+				Token(TokenType::Indent, TextPos(0, 0, 0), 2),
+				Token(TokenType::Linebreak, TextPos(0, 2, 2), 1),
+				Token(TokenType::Indent, TextPos(1, 0, 3), 2),
+				Token(TokenType::Symbol, TextPos(1, 2, 5), 2),
+				Token(TokenType::EndOfFile, TextPos(1, 4, 7), 0)
+			};
+			ParseContext context;
+			Subparser parser(tokens, context);
+
+			auto res = Swallow<Swallow<Is<TokenType::Symbol>, TokenType::Linebreak>, TokenType::Indent>::parse(parser);
+			REQUIRE(res.get_type() == ParseResult::Type::Success);
+			REQUIRE(res.get_consumed() == 4);
+
+			Subparser swallowing = parser.create_child();
+			swallowing.add_swallowed_token(TokenType::Indent);
+			REQUIRE(swallowing.peek().type() == TokenType::Linebreak);
+			swallowing.add_swallowed_token(TokenType::Linebreak);
+			REQUIRE(swallowing.peek().type() == TokenType::Symbol);
+			REQUIRE(parser.peek().type() == TokenType::Indent);
+		}
 	}
 
 
@@ -83,7 +113,8 @@ TEST_CASE("Test Parser Parts")
 			std::vector<Token> tokens{
 				Token(TokenType::Operator, TextPos(0, 0, 0), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -96,7 +127,8 @@ TEST_CASE("Test Parser Parts")
 			std::vector<Token> tokens{
 				Token(TokenType::Symbol, TextPos(0, 0, 0), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -116,7 +148,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -131,7 +164,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Operator, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -147,7 +181,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Operator, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -165,7 +200,8 @@ TEST_CASE("Test Parser Parts")
 			std::vector<Token> tokens{
 				Token(TokenType::Symbol, TextPos(0, 0, 0), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -179,7 +215,8 @@ TEST_CASE("Test Parser Parts")
 			std::vector<Token> tokens{
 				Token(TokenType::Symbol, TextPos(0, 0, 0), 2)
 			};
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -196,7 +233,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -211,7 +249,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Seperator, TextPos(0, 2, 2), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -228,7 +267,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Seperator, TextPos(0, 4, 4), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -244,7 +284,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Seperator, TextPos(0, 3, 3), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -263,7 +304,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -279,7 +321,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 2, 2), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -296,7 +339,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 3, 3), 1)
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -315,7 +359,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 5, 5), 1)
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -334,7 +379,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 6, 6), 1)
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -350,7 +396,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 3, 3), 1)
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -370,7 +417,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -388,7 +436,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -406,7 +455,8 @@ TEST_CASE("Test Parser Parts")
        		Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -427,7 +477,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -447,7 +498,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::EndOfFile, TextPos(0, 4, 4), 0),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -464,7 +516,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -481,7 +534,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -504,7 +558,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -521,7 +576,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -538,7 +594,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -556,7 +613,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -577,7 +635,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Operator, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -590,7 +649,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::If, TextPos(0, 1, 1), 1),
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -606,7 +666,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Symbol, TextPos(0, 4, 4), 1)
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Success);
@@ -620,7 +681,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::SubscopeBegin, TextPos(0, 1, 1), 1)
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -637,7 +699,8 @@ TEST_CASE("Test Parser Parts")
 				Token(TokenType::Operator, TextPos(0, 4, 4), 1)
 			};
 
-			Subparser parser(tokens);
+			ParseContext context;
+			Subparser parser(tokens, context);
 
 			auto res = element.parse(parser);
 			REQUIRE(res.get_type() == ParseResult::Type::Failure);
@@ -645,4 +708,259 @@ TEST_CASE("Test Parser Parts")
 			//REQUIRE(res.get_nodes().size() == 1);
 		}
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test Indent Stacks")
+{
+	SECTION("Push And Pop")
+	{
+		IndentStacks stacks;
+		auto outer = stacks.push(IndentStacks::EMPTY, 1);
+		auto inner = stacks.push(outer, 2);
+		auto sibling = stacks.push(outer, 3);
+
+		REQUIRE(stacks.top(IndentStacks::EMPTY) == std::nullopt);
+		REQUIRE(stacks.top(inner) == 2);
+		REQUIRE(stacks.top(sibling) == 3);
+		REQUIRE(stacks.pop(inner) == outer);
+		REQUIRE(stacks.pop(sibling) == outer);
+		REQUIRE(stacks.top(stacks.pop(inner)) == 1);
+		REQUIRE(stacks.pop(outer) == IndentStacks::EMPTY);
+	}
+
+	SECTION("Rollback")
+	{
+		IndentStacks stacks;
+		auto outer = stacks.push(IndentStacks::EMPTY, 1);
+		size_t mark = stacks.mark();
+		stacks.push(stacks.push(outer, 2), 3);
+
+		stacks.rollback(mark);
+		REQUIRE(stacks.mark() == mark);
+		REQUIRE(stacks.top(outer) == 1);
+
+		// The ids of dropped entries are handed out again
+		auto inner = stacks.push(outer, 4);
+		REQUIRE(inner == mark);
+		REQUIRE(stacks.top(inner) == 4);
+	}
+
+	SECTION("Rollback Leaves Kept Stacks")
+	{
+		IndentStacks stacks;
+		size_t mark = stacks.mark();
+		auto outer = stacks.push(IndentStacks::EMPTY, 1);
+		auto kept = stacks.push(outer, 2);
+		stacks.push(kept, 3);
+		stacks.keep(kept);
+
+		stacks.rollback(mark);
+		REQUIRE(stacks.mark() == kept + 1);
+		REQUIRE(stacks.top(kept) == 2);
+		REQUIRE(stacks.top(stacks.pop(kept)) == 1);
+	}
+
+	SECTION("Discarded Child")
+	{
+		Optional<Sequence<Indented, Is<TokenType::Symbol>>> element;
+
+		std::vector<Token> tokens{
+			Token(TokenType::Indent, TextPos(0, 0, 0), 2),
+			Token(TokenType::Operator, TextPos(0, 2, 2), 1),
+		};
+
+		ParseContext context;
+		Subparser parser(tokens, context);
+
+		auto res = element.parse(parser);
+		REQUIRE(res.get_type() == ParseResult::Type::Success);
+		REQUIRE(res.get_consumed() == 0);
+		REQUIRE(parser.context().indent_stacks().mark() == 0);
+		REQUIRE(parser.get_indent() == std::nullopt);
+	}
+
+	SECTION("Kept Repeats")
+	{
+		Repeats<Sequence<Indented, Is<TokenType::Symbol>>> element;
+
+		std::vector<Token> tokens{
+			Token(TokenType::Indent, TextPos(0, 0, 0), 1),
+			Token(TokenType::Symbol, TextPos(0, 1, 1), 1),
+			Token(TokenType::Indent, TextPos(1, 0, 2), 2),
+			Token(TokenType::Symbol, TextPos(1, 2, 4), 1),
+			Token(TokenType::Indent, TextPos(2, 0, 5), 3),
+			Token(TokenType::Operator, TextPos(2, 3, 8), 1),
+		};
+
+		ParseContext context;
+		Subparser parser(tokens, context);
+
+		auto res = element.parse(parser);
+		REQUIRE(res.get_type() == ParseResult::Type::Success);
+		REQUIRE(res.get_consumed() == 4);
+		REQUIRE(parser.context().indent_stacks().mark() == 2);
+		REQUIRE(parser.get_indent() == 2);
+	}
+
+	SECTION("Best Failure Of AnyOf")
+	{
+		AnyOf<Sequence<Indented, Is<TokenType::Symbol>>, Is<TokenType::If>> element;
+
+		std::vector<Token> tokens{
+			Token(TokenType::Indent, TextPos(0, 0, 0), 2),
+			Token(TokenType::Operator, TextPos(0, 2, 2), 1),
+		};
+
+		ParseContext context;
+		Subparser parser(tokens, context);
+
+		auto res = element.parse(parser);
+		REQUIRE(res.get_type() == ParseResult::Type::Failure);
+		REQUIRE(res.get_consumed() == 2);
+		// The parser takes over from the failed alternative, so the indent it pushed stays
+		REQUIRE(parser.get_indent() == 2);
+	}
+}
+
+TEST_CASE("Test Node Buffer")
+{
+	NodeBuffer nodes;
+	auto node = [](size_t token) { return Node(Expression(), token, token + 1); };
+	auto token_of = [&](NodeRange range, size_t index) { return std::get<0>(nodes.view(range)[index].spans_tokens()); };
+
+	Nodes first{ node(0), node(1) };
+	nodes.append(first);
+	size_t mark = nodes.mark();
+	Nodes second{ node(2), node(3) };
+	nodes.append(second);
+	KeptRange kept = nodes.keep(nodes.since(mark));
+
+	SECTION("Rollback Leaves Kept Nodes In Place")
+	{
+		nodes.rollback(mark);
+		REQUIRE(nodes.mark() == mark);
+
+		auto range = nodes.reuse(kept);
+		REQUIRE(range == kept.range);
+		REQUIRE(nodes.mark() == 4);
+		REQUIRE(token_of(*range, 0) == 2);
+		REQUIRE(token_of(*range, 1) == 3);
+	}
+
+	SECTION("Kept Nodes Elsewhere Are Copied")
+	{
+		nodes.rollback(mark - 1);
+
+		auto range = nodes.reuse(kept);
+		REQUIRE(range == NodeRange{ 1, 3 });
+		REQUIRE(token_of(*range, 0) == 2);
+		REQUIRE(token_of(*range, 1) == 3);
+	}
+
+	SECTION("Overwritten Nodes Are Not Reused")
+	{
+		nodes.rollback(mark);
+		Nodes other{ node(5) };
+		nodes.append(other);
+		nodes.rollback(mark);
+
+		REQUIRE(nodes.reuse(kept) == std::nullopt);
+	}
+
+	SECTION("Nodes Past The Kept Ones Are Dropped")
+	{
+		Nodes third{ node(4) };
+		nodes.append(third);
+		KeptRange unkept{ nodes.since(4), kept.stamp };
+		nodes.rollback(mark);
+
+		REQUIRE(nodes.reuse(unkept) == std::nullopt);
+	}
+}
+
+TEST_CASE("Test Memoized Results")
+{
+	ParseContext context(ParseOptions{ .memoize = true });
+	ParseContext::RuleId rule = &context;
+	IndentStacks& stacks = context.indent_stacks();
+	auto outer = stacks.push(IndentStacks::EMPTY, 1);
+	auto inner = stacks.push(outer, 2);
+	auto same = stacks.push(stacks.push(IndentStacks::EMPTY, 1), 2);
+	auto other = stacks.push(outer, 3);
+
+	ParserState entry{ 0, 0, inner, TokenTypeSet(), std::nullopt };
+	context.memoize(rule, entry, MemoizedResult{ ResultType::Success, entry, KeptRange() });
+
+	SECTION("Equal Indent Stacks")
+	{
+		REQUIRE(stacks.equal(inner, same));
+		REQUIRE(!stacks.equal(inner, other));
+		REQUIRE(!stacks.equal(inner, outer));
+
+		ParserState same_entry = entry;
+		same_entry.indent_stack = same;
+		REQUIRE(context.find_memoized(rule, same_entry) != nullptr);
+	}
+
+	SECTION("Several States Per Token")
+	{
+		ParserState other_entry = entry;
+		other_entry.indent_stack = other;
+		REQUIRE(context.find_memoized(rule, other_entry) == nullptr);
+
+		context.memoize(rule, other_entry, MemoizedResult{ ResultType::Failure, other_entry, KeptRange() });
+		REQUIRE(context.memoized_count() == 2);
+		REQUIRE(context.find_memoized(rule, entry)->type == ResultType::Success);
+		REQUIRE(context.find_memoized(rule, other_entry)->type == ResultType::Failure);
+	}
+}
+
+TEST_CASE("Test Parse Context Tokens")
+{
+	ParseContext context;
+
+	SECTION("Other Tokens Of The Same Size")
+	{
+		std::vector<Token> symbols{
+			Token(TokenType::Symbol, TextPos(0, 0, 0), 1),
+		};
+		std::vector<Token> literals{
+			Token(TokenType::Literal, TextPos(0, 0, 0), 1),
+		};
+
+		Subparser symbol_parser(symbols, context);
+		REQUIRE(Is<TokenType::Symbol>().parse(symbol_parser).get_type() == ParseResult::Type::Success);
+
+		// The types are not those of the first tokens just because there are as many
+		Subparser literal_parser(literals, context);
+		REQUIRE(Is<TokenType::Literal>().parse(literal_parser).get_type() == ParseResult::Type::Success);
+	}
+
+	SECTION("Extended Tokens")
+	{
+		std::vector<Token> tokens{
+			Token(TokenType::Symbol, TextPos(0, 0, 0), 1),
+		};
+		Subparser first_parser(tokens, context);
+		REQUIRE(Is<TokenType::Symbol>().parse(first_parser).get_type() == ParseResult::Type::Success);
+
+		tokens.push_back(Token(TokenType::Literal, TextPos(0, 1, 1), 1));
+		context.extend_tokens(tokens);
+
+		Subparser second_parser(tokens, context, 1);
+		REQUIRE(second_parser.token_types().size() == 2);
+		REQUIRE(Is<TokenType::Literal>().parse(second_parser).get_type() == ParseResult::Type::Success);
+	}
+
+	SECTION("Skip Links Of Extended Tokens")
+	{
+		std::vector<TokenType> types{ TokenType::Symbol, TokenType::Indent };
+		SkipLinks links;
+		REQUIRE(links.links_for(types, TokenType::Indent) == SkipLinks::Links{ 0, 2, 2 });
+
+		// The swallowed indent at the old end now skips on to the new tokens
+		types.push_back(TokenType::Indent);
+		types.push_back(TokenType::Literal);
+		REQUIRE(links.links_for(types, TokenType::Indent) == SkipLinks::Links{ 0, 3, 3, 3, 4 });
+	}
+}
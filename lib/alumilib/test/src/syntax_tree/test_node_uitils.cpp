@@ -1 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
 
+#include "alumi/parser.h"
+#include "alumi/lexer/alumi_lexicon.h"
+#include "alumi/syntax_tree/node_utils.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace alumi;
+using namespace alumi::parser;
+using namespace alumi::syntax_tree;
+
+TEST_CASE("Node Source Text")
+{
+	auto lexed_text = default_lexer.lex(u8"foo := 5\n\nbar := 6");
+
+	AlumiParser parser;
+	auto tree = parser.parse(lexed_text);
+
+	REQUIRE(tree.parse_result().get_type() == ParseResult::Type::Success);
+
+	std::vector<const Node*> assignments;
+	for (const Node& node : tree.nodes())
+	{
+		if (node.is<Assignment>())
+		{
+			assignments.push_back(&node);
+		}
+	}
+	REQUIRE(assignments.size() == 2);
+	auto literal = std::find_if(tree.nodes().begin(), tree.nodes().end(), [](const Node& node) { return node.is<Expression>(); });
+	REQUIRE(literal != tree.nodes().end());
+
+	SECTION("Includes the last token")
+	{
+		REQUIRE(as_string_deep(*literal, tree) == u8"5");
+	}
+	SECTION("Keeps line breaks as they are")
+	{
+		REQUIRE(as_string_deep(*assignments[0], tree) == u8"foo := 5\n");
+	}
+	SECTION("Ends with the text at the end of the file")
+	{
+		REQUIRE(as_string_deep(*assignments[1], tree) == u8"bar := 6");
+	}
+	SECTION("Covers the whole module")
+	{
+		REQUIRE(as_string_deep(tree.nodes().front(), tree) == u8"foo := 5\n\nbar := 6");
+	}
+}
@@ -1,7 +1,9 @@
 #include <catch2/catch_test_macros.hpp>
 
+import alumi.parser;
 import alumi.syntax_tree;
 
+#include <vector>
 #include <typeindex>
 
 using namespace alumi;
@@ -72,6 +74,9 @@ namespace {
    }
    TEST_CASE("Syntax Tree Walker")
    {
+      std::vector<Token> tokens;
+      parser::ParseContext context;
+
       SECTION("Basic Walk")
       {
          Nodes nodes;
@@ -82,7 +87,7 @@ namespace {
          nodes.insert(nodes.begin(), Node(ModuleRoot(nodes), 0, 1));
  
          
-         SyntaxTree tree(parser::ParseResult(parser::ParseResult::Type::Success, parser::Subparser({}), nodes), nullptr);
+         SyntaxTree tree(parser::ParseResult(parser::ParseResult::Type::Success, parser::Subparser(tokens, context), nodes), nullptr);
 
 
          SyntaxTreeWalker walker(tree);
@@ -108,7 +113,7 @@ namespace {
          nodes.push_back(Node(Statement({children2}), 3, 8));
          nodes.insert(nodes.end(), children2.begin(), children2.end());
 
-         SyntaxTree tree(parser::ParseResult(parser::ParseResult::Type::Success, parser::Subparser({}), nodes), nullptr);
+         SyntaxTree tree(parser::ParseResult(parser::ParseResult::Type::Success, parser::Subparser(tokens, context), nodes), nullptr);
 
 
          SyntaxTreeWalker walker(tree);